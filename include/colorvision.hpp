@@ -0,0 +1,230 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ Color vision deficiency simulation. Dichromacies use the Machado, Oliveira & Fernandes (2009) matrices at full   │
+ * │ severity, applied in linear RGB; achromatopsia keeps only the (Rec. 709) luminance. SimulateColorVision is the   │
+ * │ exact double precision reference. The renderer doesn't run it per pixel, it samples a LUT built from it once     │
+ * │ (BuildColorVisionLut), which CompareColorVisionLut measures against the reference. Daltonize is the reference    │
+ * │ for the correction passes built on top of the simulation, and CompareDaltonization measures those passes (LUT    │
+ * │ lookup, 8-bit intermediate target, shift in float) against it the same way.                                      │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+
+enum class ColorVision { NORMAL, PROTANOPIA, DEUTERANOPIA, TRITANOPIA, ACHROMATOPSIA, COUNT };
+
+inline const char* ColorVisionName(ColorVision vision) {
+  switch (vision) {
+    case ColorVision::NORMAL:
+      return "normal";
+    case ColorVision::PROTANOPIA:
+      return "protanopia";
+    case ColorVision::DEUTERANOPIA:
+      return "deuteranopia";
+    case ColorVision::TRITANOPIA:
+      return "tritanopia";
+    case ColorVision::ACHROMATOPSIA:
+      return "achromatopsia";
+    default:
+      return "?";
+  }
+}
+
+inline double SRGBToLinear(double value) {
+  return value <= 0.04045 ? value / 12.92 : std::pow((value + 0.055) / 1.055, 2.4);
+}
+
+inline double LinearToSRGB(double value) {
+  value = std::min(1.0, std::max(0.0, value));
+  return value <= 0.0031308 ? value * 12.92 : 1.055 * std::pow(value, 1.0 / 2.4) - 0.055;
+}
+
+// Linear RGB in and out (out may be out of gamut, the caller clamps)
+inline void SimulateColorVisionLinear(ColorVision vision, const double in[3], double out[3]) {
+  static const double MACHADO[3][3][3] = {
+      {{0.152286, 1.052583, -0.204868}, {0.114503, 0.786281, 0.099216}, {-0.003882, -0.048116, 1.051998}},
+      {{0.367322, 0.860646, -0.227968}, {0.280085, 0.672501, 0.047413}, {-0.011820, 0.042940, 0.968881}},
+      {{1.255528, -0.076749, -0.178779}, {-0.078411, 0.930809, 0.147602}, {0.004733, 0.691367, 0.303900}},
+  };
+
+  switch (vision) {
+    case ColorVision::PROTANOPIA:
+    case ColorVision::DEUTERANOPIA:
+    case ColorVision::TRITANOPIA: {
+      const double(&matrix)[3][3] = MACHADO[static_cast<int>(vision) - static_cast<int>(ColorVision::PROTANOPIA)];
+      for (int row = 0; row < 3; row++) {
+        out[row] = matrix[row][0] * in[0] + matrix[row][1] * in[1] + matrix[row][2] * in[2];
+      }
+      break;
+    }
+    case ColorVision::ACHROMATOPSIA:
+      out[0] = out[1] = out[2] = 0.2126 * in[0] + 0.7152 * in[1] + 0.0722 * in[2];
+      break;
+    default:
+      std::copy(in, in + 3, out);
+      break;
+  }
+}
+
+// sRGB bytes in and out, rounded to nearest
+inline void SimulateColorVision(ColorVision vision, const unsigned char in[3], unsigned char out[3]) {
+  double linear[3];
+  double simulated[3];
+  for (int channel = 0; channel < 3; channel++) linear[channel] = SRGBToLinear(in[channel] / 255.0);
+  SimulateColorVisionLinear(vision, linear, simulated);
+  for (int channel = 0; channel < 3; channel++) {
+    out[channel] = static_cast<unsigned char>(std::lround(LinearToSRGB(simulated[channel]) * 255.0));
+  }
+}
+
+// size³ RGB8 entries, red varying fastest, so it can be uploaded as is as a GL_TEXTURE_3D. Entry (r, g, b) is the
+// simulation of the sRGB color (r, g, b) / (size - 1).
+inline std::vector<unsigned char> BuildColorVisionLut(ColorVision vision, int size) {
+  std::vector<double> grid(size);
+  for (int i = 0; i < size; i++) grid[i] = SRGBToLinear(i / (size - 1.0));
+
+  std::vector<unsigned char> lut(static_cast<size_t>(size) * size * size * 3);
+  unsigned char* entry = lut.data();
+  for (int b = 0; b < size; b++) {
+    for (int g = 0; g < size; g++) {
+      for (int r = 0; r < size; r++, entry += 3) {
+        double linear[3] = {grid[r], grid[g], grid[b]};
+        double simulated[3];
+        SimulateColorVisionLinear(vision, linear, simulated);
+        for (int channel = 0; channel < 3; channel++) {
+          entry[channel] = static_cast<unsigned char>(std::lround(LinearToSRGB(simulated[channel]) * 255.0));
+        }
+      }
+    }
+  }
+  return lut;
+}
+
+// Daltonization (Fidaner, Lin & Ozguven): the error between a color and its simulation is what the viewer can't
+// see, so it's shifted into channels they can and added back. Only dichromacies have such channels, so this returns
+// false for the other modes. Rows of the matrix that turns the linear RGB error into the shift.
+inline bool DaltonizeShift(ColorVision vision, float shift[3][3]) {
+  static const float PROTAN_DEUTAN[3][3] = {{0.0f, 0.0f, 0.0f}, {0.7f, 1.0f, 0.0f}, {0.7f, 0.0f, 1.0f}};
+  static const float TRITAN[3][3] = {{1.0f, 0.0f, 0.7f}, {0.0f, 1.0f, 0.7f}, {0.0f, 0.0f, 0.0f}};
+  const float(*matrix)[3] = nullptr;
+  if (vision == ColorVision::PROTANOPIA || vision == ColorVision::DEUTERANOPIA) matrix = PROTAN_DEUTAN;
+  if (vision == ColorVision::TRITANOPIA) matrix = TRITAN;
+  if (!matrix) return false;
+  std::copy(&matrix[0][0], &matrix[0][0] + 9, &shift[0][0]);
+  return true;
+}
+
+// Reference for the GPU daltonization passes: simulate, take the error, shift it and add it back, in linear RGB
+inline void Daltonize(ColorVision vision, const unsigned char in[3], unsigned char out[3]) {
+  float shift[3][3];
+  if (!DaltonizeShift(vision, shift)) {
+    std::copy(in, in + 3, out);
+    return;
+  }
+  double linear[3];
+  double simulated[3];
+  for (int channel = 0; channel < 3; channel++) linear[channel] = SRGBToLinear(in[channel] / 255.0);
+  SimulateColorVisionLinear(vision, linear, simulated);
+  // What the viewer sees is the simulation as displayed, so out of gamut parts are clipped like the passes' target does
+  for (double& value : simulated) value = std::min(1.0, std::max(0.0, value));
+  for (int row = 0; row < 3; row++) {
+    double corrected = linear[row];
+    for (int column = 0; column < 3; column++) corrected += shift[row][column] * (linear[column] - simulated[column]);
+    out[row] = static_cast<unsigned char>(std::lround(LinearToSRGB(corrected) * 255.0));
+  }
+}
+
+struct LutError {
+  double meanError;
+  int maxError;
+};
+
+// Trilinear lookup into the LUT (what the GPU sampler does), rounded to 8 bits like a render target stores it
+inline void SampleColorVisionLut(const std::vector<unsigned char>& lut, int size, const unsigned char color[3],
+                                 unsigned char out[3]) {
+  auto at = [&](int r, int g, int b, int channel) {
+    return lut[((static_cast<size_t>(b) * size + g) * size + r) * 3 + channel];
+  };
+
+  double position[3];
+  int low[3];
+  for (int channel = 0; channel < 3; channel++) {
+    position[channel] = color[channel] / 255.0 * (size - 1);
+    low[channel] = std::min(size - 2, static_cast<int>(position[channel]));
+    position[channel] -= low[channel];
+  }
+  for (int channel = 0; channel < 3; channel++) {
+    double value = 0.0;
+    for (int corner = 0; corner < 8; corner++) {
+      const int dr = corner & 1, dg = (corner >> 1) & 1, db = (corner >> 2) & 1;
+      const double weight = (dr ? position[0] : 1.0 - position[0]) * (dg ? position[1] : 1.0 - position[1]) *
+                            (db ? position[2] : 1.0 - position[2]);
+      value += weight * at(low[0] + dr, low[1] + dg, low[2] + db, channel);
+    }
+    out[channel] = static_cast<unsigned char>(std::lround(value));
+  }
+}
+
+// Runs compute(color, result) over every step-th value of each channel and compares the results with reference's.
+// Errors are in 8-bit levels, per channel.
+template <typename Reference, typename Compute>
+LutError CompareOverColorGrid(int step, Reference reference, Compute compute) {
+  LutError error = {0.0, 0};
+  size_t samples = 0;
+  for (int b = 0; b < 256; b += step) {
+    for (int g = 0; g < 256; g += step) {
+      for (int r = 0; r < 256; r += step) {
+        const unsigned char color[3] = {static_cast<unsigned char>(r), static_cast<unsigned char>(g),
+                                        static_cast<unsigned char>(b)};
+        unsigned char expected[3];
+        unsigned char actual[3];
+        reference(color, expected);
+        compute(color, actual);
+        for (int channel = 0; channel < 3; channel++) {
+          const int difference = std::abs(actual[channel] - expected[channel]);
+          error.meanError += difference;
+          error.maxError = std::max(error.maxError, difference);
+          samples++;
+        }
+      }
+    }
+  }
+  error.meanError /= std::max<size_t>(1, samples);
+  return error;
+}
+
+// How far a lookup into the LUT strays from the reference simulation
+inline LutError CompareColorVisionLut(ColorVision vision, const std::vector<unsigned char>& lut, int size, int step) {
+  return CompareOverColorGrid(
+      step, [&](const unsigned char* color, unsigned char* out) { SimulateColorVision(vision, color, out); },
+      [&](const unsigned char* color, unsigned char* out) { SampleColorVisionLut(lut, size, color, out); });
+}
+
+// How far the GPU daltonization passes stray from Daltonize: the simulation comes from the LUT and goes through an
+// 8-bit render target, then the error is shifted and added back in single precision, like the shader does
+inline LutError CompareDaltonization(ColorVision vision, const std::vector<unsigned char>& lut, int size, int step) {
+  float shift[3][3];
+  if (!DaltonizeShift(vision, shift)) return {0.0, 0};
+  return CompareOverColorGrid(
+      step, [&](const unsigned char* color, unsigned char* out) { Daltonize(vision, color, out); },
+      [&](const unsigned char* color, unsigned char* out) {
+        unsigned char simulated[3];
+        SampleColorVisionLut(lut, size, color, simulated);
+        float error[3];
+        float linear[3];
+        for (int channel = 0; channel < 3; channel++) {
+          linear[channel] = static_cast<float>(SRGBToLinear(color[channel] / 255.0));
+          error[channel] = linear[channel] - static_cast<float>(SRGBToLinear(simulated[channel] / 255.0));
+        }
+        for (int row = 0; row < 3; row++) {
+          float corrected = linear[row];
+          for (int column = 0; column < 3; column++) corrected += shift[row][column] * error[column];
+          out[row] = static_cast<unsigned char>(std::lround(LinearToSRGB(corrected) * 255.0));
+        }
+      });
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ Per-frame CPU timings, split by phase of the render loop. GetFPS is an average and hides exactly the hitches we  │
+ * │ care about, so every frame's phase durations go into a ring buffer and the panel shows percentiles and a graph   │
+ * │ of the last few seconds instead. Optionally every sample since launch is also kept, to be dumped as CSV on exit. │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+class FrameTimings {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  enum Phase { INPUT, CAMERA, UPLOAD, DRAW, PRESENT, PHASE_COUNT };
+
+  struct Sample {
+    std::array<float, PHASE_COUNT> phaseMs;
+    float totalMs;
+  };
+
+  struct Stats {
+    float p50 = 0.0f;
+    float p95 = 0.0f;
+    float p99 = 0.0f;
+    float max = 0.0f;
+  };
+
+  static constexpr size_t CAPACITY = 512;
+
+  bool keepAll = false;  // also keep every sample for WriteCsv, not just the last CAPACITY
+
+  FrameTimings() { sorted.reserve(CAPACITY); }
+
+  void BeginFrame() {
+    current = {};
+    phaseStart = Clock::now();
+  }
+
+  // Closes the phase that started at the previous Mark (or at BeginFrame)
+  void Mark(Phase phase) {
+    Clock::time_point now = Clock::now();
+    current.phaseMs[phase] += std::chrono::duration<float, std::milli>(now - phaseStart).count();
+    phaseStart = now;
+  }
+
+  // Frames that slept waiting for input would only measure how long nobody touched anything, so they're dropped
+  void EndFrame(bool record = true) {
+    if (!record) return;
+    current.totalMs = 0.0f;
+    for (float ms : current.phaseMs) current.totalMs += ms;
+
+    ring[next] = current;
+    next = (next + 1) % CAPACITY;
+    count = std::min(count + 1, CAPACITY);
+    recorded++;
+    if (keepAll) all.push_back(current);
+  }
+
+  size_t Count() const { return count; }
+
+  // i = 0 is the oldest sample still in the ring, Count() - 1 the latest
+  const Sample& At(size_t i) const { return ring[(next + CAPACITY - count + i) % CAPACITY]; }
+
+  // Percentiles of the total frame time over the ring, recomputed only when new samples came in
+  const Stats& TotalStats() {
+    if (statsRecorded == recorded) return stats;
+    statsRecorded = recorded;
+
+    sorted.clear();
+    for (size_t i = 0; i < count; i++) sorted.push_back(At(i).totalMs);
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&](float p) { return sorted[static_cast<size_t>(p * (count - 1) + 0.5f)]; };
+    stats = count == 0 ? Stats{} : Stats{percentile(0.50f), percentile(0.95f), percentile(0.99f), sorted.back()};
+    return stats;
+  }
+
+  bool WriteCsv(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) return false;
+
+    out << "frame,input_ms,camera_ms,upload_ms,draw_ms,present_ms,total_ms\n";
+    auto write = [&](size_t frame, const Sample& sample) {
+      out << frame;
+      for (float ms : sample.phaseMs) out << ',' << ms;
+      out << ',' << sample.totalMs << '\n';
+    };
+    if (keepAll) {
+      for (size_t i = 0; i < all.size(); i++) write(i, all[i]);
+    } else {
+      for (size_t i = 0; i < count; i++) write(recorded - count + i, At(i));
+    }
+    return out.good();
+  }
+
+ private:
+  std::array<Sample, CAPACITY> ring = {};
+  size_t next = 0;
+  size_t count = 0;
+  size_t recorded = 0;
+  std::vector<Sample> all;
+
+  Sample current = {};
+  Clock::time_point phaseStart = Clock::now();
+
+  Stats stats;
+  size_t statsRecorded = 0;
+  std::vector<float> sorted;
+};
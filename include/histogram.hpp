@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ Histogram binning kernels for RGBA pixels: one 256-bin histogram each for R, G, B and luma (Rec. 709 weights in  │
+ * │ 8.8 fixed point, so every kernel agrees to the bit). Binning itself is a scatter and stays scalar, but the SSE2  │
+ * │ version loads 4 pixels at a time and computes their luma with a single multiply-add, which is most of the work.  │
+ * │ SSE2 is part of x86-64, so unlike the swizzle kernels there's nothing to pick at runtime.                        │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+
+struct ChannelHistograms {
+  enum Channel { RED, GREEN, BLUE, LUMA, CHANNEL_COUNT };
+
+  uint32_t bins[CHANNEL_COUNT][256];
+};
+
+inline unsigned LumaOf(unsigned r, unsigned g, unsigned b) { return (54 * r + 183 * g + 19 * b + 128) >> 8; }
+
+inline void BinRGBAScalar(const unsigned char* rgba, size_t pixelCount, ChannelHistograms& histograms) {
+  for (size_t i = 0; i < pixelCount; i++, rgba += 4) {
+    histograms.bins[ChannelHistograms::RED][rgba[0]]++;
+    histograms.bins[ChannelHistograms::GREEN][rgba[1]]++;
+    histograms.bins[ChannelHistograms::BLUE][rgba[2]]++;
+    histograms.bins[ChannelHistograms::LUMA][LumaOf(rgba[0], rgba[1], rgba[2])]++;
+  }
+}
+
+#if defined(__SSE2__)
+
+inline void BinRGBASSE2(const unsigned char* rgba, size_t pixelCount, ChannelHistograms& histograms) {
+  // madd pairs up (R, G) and (B, A) of each pixel; alpha gets a weight of 0
+  const __m128i weights = _mm_setr_epi16(54, 183, 19, 0, 54, 183, 19, 0);
+  const __m128i rounding = _mm_set1_epi32(128);
+  const __m128i zero = _mm_setzero_si128();
+  alignas(16) uint32_t luma[4];
+
+  size_t i = 0;
+  for (; i + 4 <= pixelCount; i += 4, rgba += 16) {
+    __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgba));
+    __m128i low = _mm_madd_epi16(_mm_unpacklo_epi8(pixels, zero), weights);   // pixels 0 and 1
+    __m128i high = _mm_madd_epi16(_mm_unpackhi_epi8(pixels, zero), weights);  // pixels 2 and 3
+    // Fold each pixel's (R, G) and (B, A) partial sums into the even lanes, then gather the four even lanes
+    low = _mm_add_epi32(low, _mm_srli_epi64(low, 32));
+    high = _mm_add_epi32(high, _mm_srli_epi64(high, 32));
+    __m128i sums = _mm_unpacklo_epi64(_mm_shuffle_epi32(low, _MM_SHUFFLE(3, 1, 2, 0)),
+                                      _mm_shuffle_epi32(high, _MM_SHUFFLE(3, 1, 2, 0)));
+    _mm_store_si128(reinterpret_cast<__m128i*>(luma), _mm_srli_epi32(_mm_add_epi32(sums, rounding), 8));
+
+    for (int p = 0; p < 4; p++) {
+      histograms.bins[ChannelHistograms::RED][rgba[p * 4 + 0]]++;
+      histograms.bins[ChannelHistograms::GREEN][rgba[p * 4 + 1]]++;
+      histograms.bins[ChannelHistograms::BLUE][rgba[p * 4 + 2]]++;
+      histograms.bins[ChannelHistograms::LUMA][luma[p]]++;
+    }
+  }
+  BinRGBAScalar(rgba, pixelCount - i, histograms);
+}
+
+#endif
+
+inline void BinRGBA(const unsigned char* rgba, size_t pixelCount, ChannelHistograms& histograms) {
+#if defined(__SSE2__)
+  BinRGBASSE2(rgba, pixelCount, histograms);
+#else
+  BinRGBAScalar(rgba, pixelCount, histograms);
+#endif
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ PNG encoder for big RGBA buffers that deflates horizontal strips in parallel (the pigz trick). Each strip is an  │
+ * │ independent raw deflate stream ended with Z_SYNC_FLUSH instead of Z_FINISH, so it stops byte aligned without a   │
+ * │ final block and the strips simply concatenate into one valid zlib stream; the last strip finishes it, and the    │
+ * │ Adler-32 of the whole image is stitched together from the strips' own with adler32_combine. Every strip becomes  │
+ * │ its own IDAT chunk, so the CRCs are computed in parallel too. Rows use the Up filter, which only looks at the    │
+ * │ row above in the source, so strips don't depend on each other. Alpha is dropped: captures are always opaque.     │
+ * │ It runs on its own threads rather than the shared worker pool, since a long export would otherwise queue in      │
+ * │ front of the render loop's own parallel work.                                                                    │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+
+struct PngProgress {
+  std::atomic<int> stripsDone{0};
+  std::atomic<int> stripCount{0};
+};
+
+namespace png_detail {
+
+inline void PutU32(std::vector<unsigned char>& out, uint32_t value) {
+  out.push_back(static_cast<unsigned char>(value >> 24));
+  out.push_back(static_cast<unsigned char>(value >> 16));
+  out.push_back(static_cast<unsigned char>(value >> 8));
+  out.push_back(static_cast<unsigned char>(value));
+}
+
+// Length, type, data and CRC (of the type and data) of one chunk
+inline void WriteChunk(std::ofstream& out, const char type[4], const unsigned char* data, size_t size,
+                       uint32_t crc) {
+  std::vector<unsigned char> length;
+  PutU32(length, static_cast<uint32_t>(size));
+  std::vector<unsigned char> trailer;
+  PutU32(trailer, crc);
+  out.write(reinterpret_cast<const char*>(length.data()), 4);
+  out.write(type, 4);
+  out.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+  out.write(reinterpret_cast<const char*>(trailer.data()), 4);
+}
+
+inline uint32_t ChunkCrc(const char type[4], const unsigned char* data, size_t size) {
+  uLong crc = crc32(0L, reinterpret_cast<const Bytef*>(type), 4);
+  if (size > 0) crc = crc32_z(crc, data, size);  // a null buffer would reset the CRC instead
+  return static_cast<uint32_t>(crc);
+}
+
+struct Strip {
+  std::vector<unsigned char> deflated;
+  uLong adler = 1;
+  size_t rawSize = 0;
+  uint32_t crc = 0;
+  bool ok = false;
+};
+
+}  // namespace png_detail
+
+// rgba points at the top-left pixel of the image, rows are stride pixels apart
+inline bool WritePng(const std::string& path, const unsigned char* rgba, int width, int height, size_t stride,
+                     PngProgress& progress, unsigned threadCount, int rowsPerStrip = 64, int level = 3) {
+  using namespace png_detail;
+  if (width <= 0 || height <= 0) return false;
+
+  const int stripCount = (height + rowsPerStrip - 1) / rowsPerStrip;
+  const size_t rowBytes = static_cast<size_t>(width) * 3 + 1;  // filter byte, then RGB
+  std::vector<Strip> strips(stripCount);
+  progress.stripsDone = 0;
+  progress.stripCount = stripCount;
+
+  auto encodeStrip = [&](int index) {
+    Strip& strip = strips[index];
+    const int firstRow = index * rowsPerStrip;
+    const int rowCount = std::min(rowsPerStrip, height - firstRow);
+    const bool last = index == stripCount - 1;
+
+    // Filtered rows (Up: each byte minus the same byte of the row above, zeros above the first row)
+    std::vector<unsigned char> raw(rowBytes * rowCount);
+    for (int row = 0; row < rowCount; row++) {
+      const int y = firstRow + row;
+      const unsigned char* pixel = rgba + static_cast<size_t>(y) * stride * 4;
+      const unsigned char* above = y > 0 ? pixel - stride * 4 : nullptr;
+      unsigned char* out = raw.data() + row * rowBytes;
+      *out++ = 2;
+      for (int x = 0; x < width; x++, pixel += 4, out += 3) {
+        for (int channel = 0; channel < 3; channel++) {
+          out[channel] = static_cast<unsigned char>(pixel[channel] - (above ? above[x * 4 + channel] : 0));
+        }
+      }
+    }
+    strip.rawSize = raw.size();
+    strip.adler = adler32_z(1L, raw.data(), raw.size());
+
+    z_stream stream = {};
+    if (deflateInit2(&stream, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) return;
+    // Room for the zlib header in front of the first strip and the Adler-32 after the last one
+    strip.deflated.resize(2 + deflateBound(&stream, raw.size()) + 16 + 4);
+    const size_t offset = index == 0 ? 2 : 0;
+    stream.next_in = raw.data();
+    stream.avail_in = static_cast<uInt>(raw.size());
+    stream.next_out = strip.deflated.data() + offset;
+    stream.avail_out = static_cast<uInt>(strip.deflated.size() - offset);
+    const int result = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+    strip.ok = last ? result == Z_STREAM_END : result == Z_OK && stream.avail_in == 0;
+    strip.deflated.resize(offset + stream.total_out);
+    deflateEnd(&stream);
+
+    if (index == 0) {
+      strip.deflated[0] = 0x78;  // deflate, 32K window
+      strip.deflated[1] = 0x9C;  // default compression, header check bits
+    }
+    if (!last) strip.crc = ChunkCrc("IDAT", strip.deflated.data(), strip.deflated.size());
+    progress.stripsDone++;
+  };
+
+  std::atomic<int> nextStrip{0};
+  std::vector<std::thread> threads;
+  for (unsigned i = 0; i < std::max(1u, threadCount); i++) {
+    threads.emplace_back([&]() {
+      for (int index = nextStrip++; index < stripCount; index = nextStrip++) encodeStrip(index);
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+
+  uLong adler = 1;
+  for (const Strip& strip : strips) {
+    if (!strip.ok) return false;
+    adler = adler32_combine(adler, strip.adler, static_cast<z_off_t>(strip.rawSize));
+  }
+  Strip& lastStrip = strips.back();
+  std::vector<unsigned char> checksum;
+  PutU32(checksum, static_cast<uint32_t>(adler));
+  lastStrip.deflated.insert(lastStrip.deflated.end(), checksum.begin(), checksum.end());
+  lastStrip.crc = ChunkCrc("IDAT", lastStrip.deflated.data(), lastStrip.deflated.size());
+
+  std::ofstream out(path, std::ios::binary);
+  if (!out) return false;
+  static const unsigned char SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  out.write(reinterpret_cast<const char*>(SIGNATURE), sizeof(SIGNATURE));
+
+  std::vector<unsigned char> header;
+  PutU32(header, static_cast<uint32_t>(width));
+  PutU32(header, static_cast<uint32_t>(height));
+  header.insert(header.end(), {8, 2, 0, 0, 0});  // 8 bits per channel, RGB, deflate, adaptive filters, no interlace
+  WriteChunk(out, "IHDR", header.data(), header.size(), ChunkCrc("IHDR", header.data(), header.size()));
+  for (const Strip& strip : strips) WriteChunk(out, "IDAT", strip.deflated.data(), strip.deflated.size(), strip.crc);
+  WriteChunk(out, "IEND", nullptr, 0, ChunkCrc("IEND", nullptr, 0));
+  return out.good();
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ Records high-resolution timestamps for the phases between launch (or a daemon activation) and the first frame.   │
+ * │ Phases nest (a capture contains its XSync and XShmGetImage, for instance) and are reported either as a plain     │
+ * │ table or as Chrome trace JSON (chrome://tracing, Perfetto, speedscope) so runs can be compared across builds     │
+ * │ and machines. While disabled, Begin/End do nothing but check a flag, so the instrumentation can stay in place.   │
+ * │ Only the thread that last called Reset is recorded; code that also runs on background threads (the streamed      │
+ * │ capture of the rest of the desktop) would otherwise interleave its phases with the main thread's. Those threads  │
+ * │ still run the checks while the main thread calls Reset and Finish, so the flags and the owner are atomics; the   │
+ * │ phases themselves are only ever touched by the owner.                                                            │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+class StartupProfiler {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Phase {
+    std::string name;
+    double startMs;
+    double durationMs;
+    int depth;
+  };
+
+  std::atomic<bool> enabled{false};
+
+  // Everything is timed relative to the last Reset (process launch, then every daemon activation)
+  void Reset(Clock::time_point newOrigin = Clock::now()) {
+    origin = newOrigin;
+    owner = std::this_thread::get_id();
+    recording = true;
+    phases.clear();
+    openPhases.clear();
+  }
+
+  void Begin(const char* name) {
+    if (!enabled || !recording || std::this_thread::get_id() != owner) return;
+    openPhases.push_back(phases.size());
+    phases.push_back({name, SinceOrigin(Clock::now()), 0.0, static_cast<int>(openPhases.size()) - 1});
+  }
+
+  void End() {
+    if (!enabled || !recording || std::this_thread::get_id() != owner || openPhases.empty()) return;
+    Phase& phase = phases[openPhases.back()];
+    phase.durationMs = SinceOrigin(Clock::now()) - phase.startMs;
+    openPhases.pop_back();
+  }
+
+  // Stops recording until the next Reset, so code that keeps running after the first frame (live updates, for one)
+  // doesn't pile up phases nobody is going to report
+  void Finish() { recording = false; }
+
+  // RAII helper, so early returns still close their phase
+  class Scope {
+   public:
+    Scope(StartupProfiler& profiler, const char* name) : profiler(profiler) { profiler.Begin(name); }
+    ~Scope() { profiler.End(); }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+   private:
+    StartupProfiler& profiler;
+  };
+
+  void PrintTable(std::ostream& out) const {
+    if (!enabled) return;
+
+    char line[160];
+    std::snprintf(line, sizeof(line), "%-48s %10s %10s\n", "phase", "start ms", "duration");
+    out << "\nStartup profile:\n" << line;
+    for (const auto& phase : phases) {
+      std::string name = std::string(phase.depth * 2, ' ') + phase.name;
+      std::snprintf(line, sizeof(line), "%-48s %10.3f %10.3f\n", name.c_str(), phase.startMs, phase.durationMs);
+      out << line;
+    }
+    out << std::endl;
+  }
+
+  // Chrome trace event format: one complete ("X") event per phase, timestamps in microseconds
+  bool WriteChromeTrace(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) return false;
+
+    out << "{\"traceEvents\":[\n";
+    for (size_t i = 0; i < phases.size(); i++) {
+      const Phase& phase = phases[i];
+      out << "  {\"name\":\"" << EscapeJson(phase.name) << "\",\"cat\":\"startup\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+          << ",\"ts\":" << phase.startMs * 1000.0 << ",\"dur\":" << phase.durationMs * 1000.0 << "}"
+          << (i + 1 < phases.size() ? ",\n" : "\n");
+    }
+    out << "],\"displayTimeUnit\":\"ms\"}\n";
+    return out.good();
+  }
+
+ private:
+  Clock::time_point origin = Clock::now();
+  std::atomic<std::thread::id> owner{std::this_thread::get_id()};
+  std::atomic<bool> recording{true};
+  std::vector<Phase> phases;
+  std::vector<size_t> openPhases;
+
+  double SinceOrigin(Clock::time_point time) const {
+    return std::chrono::duration<double, std::milli>(time - origin).count();
+  }
+
+  static std::string EscapeJson(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+      if (c == '"' || c == '\\') escaped += '\\';
+      escaped += c;
+    }
+    return escaped;
+  }
+};
+
+// Process-wide profiler, so phases deep inside the capture code can be timed without threading it through every call
+inline StartupProfiler& Profiler() {
+  static StartupProfiler profiler;
+  return profiler;
+}
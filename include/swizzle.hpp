@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define URBLIND_SWIZZLE_X86 1
+#endif
+
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ BGRX → RGBA swizzle kernels. X hands us 32-bit pixels as B, G, R, X (the X byte is garbage, not alpha), and we   │
+ * │ need R, G, B, 255 for the texture. The scalar version is the reference; the SSSE3 and AVX2 versions do the very  │
+ * │ same thing 4 or 8 pixels at a time with a byte shuffle (pshufb) and an OR to force alpha to 255. The best one    │
+ * │ the CPU supports is picked once at runtime via CPUID, so the binary still runs on machines without AVX2.         │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+
+using SwizzleKernel = void (*)(const unsigned char* src, unsigned char* dst, size_t pixelCount);
+
+inline void SwizzleBGRXToRGBAScalar(const unsigned char* src, unsigned char* dst, size_t pixelCount) {
+  for (size_t i = 0; i < pixelCount; i++) {
+    size_t pixelIndex = i * 4;
+    dst[pixelIndex + 0] = src[pixelIndex + 2];  // R
+    dst[pixelIndex + 1] = src[pixelIndex + 1];  // G
+    dst[pixelIndex + 2] = src[pixelIndex + 0];  // B
+    dst[pixelIndex + 3] = 255;                  // Alpha (fully opaque)
+  }
+}
+
+#if defined(URBLIND_SWIZZLE_X86)
+
+__attribute__((target("ssse3"))) inline void SwizzleBGRXToRGBASSSE3(const unsigned char* src, unsigned char* dst,
+                                                                    size_t pixelCount) {
+  // Shuffle indexes for 4 pixels; -1 (high bit set) zeroes the X byte so the OR below can write alpha into it
+  const __m128i shuffle = _mm_setr_epi8(2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1);
+  const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+
+  size_t i = 0;
+  for (; i + 4 <= pixelCount; i += 4) {
+    __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+    pixels = _mm_or_si128(_mm_shuffle_epi8(pixels, shuffle), alpha);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), pixels);
+  }
+  SwizzleBGRXToRGBAScalar(src + i * 4, dst + i * 4, pixelCount - i);
+}
+
+__attribute__((target("avx2"))) inline void SwizzleBGRXToRGBAAVX2(const unsigned char* src, unsigned char* dst,
+                                                                  size_t pixelCount) {
+  // vpshufb shuffles within each 128-bit lane, so the same 4-pixel pattern is simply repeated for both lanes
+  const __m256i shuffle = _mm256_setr_epi8(2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1,  //
+                                           2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1);
+  const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+
+  size_t i = 0;
+  for (; i + 16 <= pixelCount; i += 16) {
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4 + 32));
+    a = _mm256_or_si256(_mm256_shuffle_epi8(a, shuffle), alpha);
+    b = _mm256_or_si256(_mm256_shuffle_epi8(b, shuffle), alpha);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), a);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4 + 32), b);
+  }
+  for (; i + 8 <= pixelCount; i += 8) {
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+    a = _mm256_or_si256(_mm256_shuffle_epi8(a, shuffle), alpha);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), a);
+  }
+  SwizzleBGRXToRGBAScalar(src + i * 4, dst + i * 4, pixelCount - i);
+}
+
+#endif
+
+struct SwizzleKernelInfo {
+  const char* name;
+  SwizzleKernel kernel;
+};
+
+inline SwizzleKernelInfo SelectSwizzleKernel() {
+#if defined(URBLIND_SWIZZLE_X86)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return {"AVX2", SwizzleBGRXToRGBAAVX2};
+  if (__builtin_cpu_supports("ssse3")) return {"SSSE3", SwizzleBGRXToRGBASSSE3};
+#endif
+  return {"scalar", SwizzleBGRXToRGBAScalar};
+}
+
+// Every kernel this CPU can run, the scalar reference first, so they can be checked against each other
+inline std::vector<SwizzleKernelInfo> AvailableSwizzleKernels() {
+  std::vector<SwizzleKernelInfo> kernels = {{"scalar", SwizzleBGRXToRGBAScalar}};
+#if defined(URBLIND_SWIZZLE_X86)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("ssse3")) kernels.push_back({"SSSE3", SwizzleBGRXToRGBASSSE3});
+  if (__builtin_cpu_supports("avx2")) kernels.push_back({"AVX2", SwizzleBGRXToRGBAAVX2});
+#endif
+  return kernels;
+}
+
+inline const SwizzleKernelInfo& ActiveSwizzleKernel() {
+  static const SwizzleKernelInfo info = SelectSwizzleKernel();
+  return info;
+}
+
+inline void SwizzleBGRXToRGBA(const unsigned char* src, unsigned char* dst, size_t pixelCount) {
+  ActiveSwizzleKernel().kernel(src, dst, pixelCount);
+}
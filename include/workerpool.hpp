@@ -0,0 +1,112 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ A tiny fixed-size thread pool. It only knows how to run a ParallelFor over an index range split into contiguous  │
+ * │ bands (e.g. image rows), with the calling thread working on the first band instead of just sitting there. The    │
+ * │ threads are started once and reused, so splitting a job costs a couple of condition variable round trips rather  │
+ * │ than spawning threads every time.                                                                                │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+class WorkerPool {
+ public:
+  explicit WorkerPool(unsigned threadCount = std::max(1u, std::thread::hardware_concurrency())) {
+    // The caller of ParallelFor is one of the workers, so we only need threadCount - 1 extra threads
+    for (unsigned i = 1; i < threadCount; i++) {
+      threads.emplace_back([this]() { WorkerLoop(); });
+    }
+  }
+
+  ~WorkerPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    wake.notify_all();
+    for (auto& thread : threads) thread.join();
+  }
+
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  // Number of threads that can work on a ParallelFor at the same time (pool threads + the calling thread)
+  unsigned Size() const { return static_cast<unsigned>(threads.size()) + 1; }
+
+  // Runs fn(bandBegin, bandEnd) over [begin, end) split into at most maxBands bands (0 = one per thread), each at
+  // least minPerBand long. Blocks until every band is done.
+  void ParallelFor(int begin, int end, const std::function<void(int, int)>& fn, unsigned maxBands = 0,
+                   int minPerBand = 1) {
+    int count = end - begin;
+    if (count <= 0) return;
+
+    unsigned bands = maxBands == 0 ? Size() : std::min(maxBands, Size());
+    bands = std::min<unsigned>(bands, std::max(1, count / std::max(1, minPerBand)));
+    if (bands <= 1) {
+      fn(begin, end);
+      return;
+    }
+
+    struct Latch {
+      std::mutex mutex;
+      std::condition_variable done;
+      unsigned remaining;
+    } latch;
+    latch.remaining = bands - 1;
+
+    auto bandStart = [&](unsigned band) { return begin + static_cast<int>(static_cast<long long>(count) * band / bands); };
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      for (unsigned band = 1; band < bands; band++) {
+        int bandBegin = bandStart(band);
+        int bandEnd = bandStart(band + 1);
+        tasks.emplace_back([&fn, &latch, bandBegin, bandEnd]() {
+          fn(bandBegin, bandEnd);
+          std::lock_guard<std::mutex> latchLock(latch.mutex);
+          if (--latch.remaining == 0) latch.done.notify_one();
+        });
+      }
+    }
+    wake.notify_all();
+
+    fn(begin, bandStart(1));
+
+    std::unique_lock<std::mutex> latchLock(latch.mutex);
+    latch.done.wait(latchLock, [&]() { return latch.remaining == 0; });
+  }
+
+ private:
+  std::vector<std::thread> threads;
+  std::deque<std::function<void()>> tasks;
+  std::mutex mutex;
+  std::condition_variable wake;
+  bool stopping = false;
+
+  void WorkerLoop() {
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        wake.wait(lock, [this]() { return stopping || !tasks.empty(); });
+        if (stopping && tasks.empty()) return;
+        task = std::move(tasks.front());
+        tasks.pop_front();
+      }
+      task();
+    }
+  }
+};
+
+// Process-wide pool, created the first time somebody needs it
+inline WorkerPool& SharedWorkerPool() {
+  static WorkerPool pool;
+  return pool;
+}
@@ -1,22 +1,64 @@
+#include <fcntl.h>
+#include <poll.h>
 #include <sys/ioctl.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 #include <unistd.h>
 
 #include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
 #include <cmath>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
 #include <cstring>
+#include <ctime>
+#include <deque>
 #include <functional>
 #include <iostream>
 #include <locale>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <thread>
 #include <vector>
 
-#include "../include/monospacedfont.hpp"
+#include "../include/colorvision.hpp"
+#include "../include/frametimings.hpp"
+#include "../include/histogram.hpp"
+#include "../include/pngwriter.hpp"
+#include "../include/startupprofiler.hpp"
+#include "../include/swizzle.hpp"
+#include "../include/workerpool.hpp"
+#include "debugfontatlas.hpp"  // generated at build time by tools/bakefont.cpp
 #include "raylib.h"
+#include "raymath.h"
+#include "rlgl.h"
+
+// We need a handful of plain GL calls (texture swizzle, 3D textures) on top of rlgl, straight from the system's libGL
+#include <GL/gl.h>
+#ifndef GL_TEXTURE_SWIZZLE_R
+#define GL_TEXTURE_SWIZZLE_R 0x8E42
+#define GL_TEXTURE_SWIZZLE_B 0x8E44
+#define GL_TEXTURE_SWIZZLE_A 0x8E45
+#endif
+
+// raylib is built with GLFW inside it but doesn't wrap this one. It is the thread-safe way to make the render loop's
+// event wait return, so capture threads can wake an idle loop up when they have new pixels for it.
+extern "C" void glfwPostEmptyEvent(void);
 
 // X11 headers with a #define namespace conflict avoidance hack (Xlib's Font conflicts with Raylib's Font)
 #define Font XFont
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+#include <X11/extensions/Xdamage.h>
+#include <X11/extensions/Xfixes.h>
 #undef Font
 
 // TODO: Implement a shader-based paint brush to highlight parts of the texture.
@@ -41,6 +83,7 @@ class MonitorState {
   MonitorState() { retrieveMonitorData(); }
 
   void retrieveMonitorData() {
+    StartupProfiler::Scope phase(Profiler(), "MonitorState::retrieveMonitorData");
     int monitorCount = GetMonitorCount();
     if (monitorCount == 0) {
       std::cerr << "No monitors detected!" << std::endl;
@@ -114,336 +157,3580 @@ class MonitorState {
   }
 };
 
+enum class CaptureBackend { NONE, XSHM, XGETIMAGE };
+
+const char* CaptureBackendName(CaptureBackend backend) {
+  switch (backend) {
+    case CaptureBackend::XSHM:
+      return "XShm";
+    case CaptureBackend::XGETIMAGE:
+      return "XGetImage";
+    default:
+      return "none";
+  }
+}
+
+// XShmAttach reports failures (e.g. a remote DISPLAY that can't see our segment) asynchronously through the X error
+// handler, so we temporarily swap in this one to find out whether the attach worked instead of crashing on BadAccess.
+// The handler is process-wide and captures also run on background threads, so attaches take turns.
+static bool xShmAttachFailed = false;
+static std::mutex xShmAttachMutex;
+
+int HandleShmAttachError(Display* display, XErrorEvent* event) {
+  xShmAttachFailed = true;
+  return 0;
+}
+
+void ReleaseImageXShm(Display* display, XImage* img, XShmSegmentInfo& shmInfo) {
+  XShmDetach(display, &shmInfo);
+  img->data = nullptr;  // the pixels live in the shared segment, so XDestroyImage must not free() them
+  XDestroyImage(img);
+  shmdt(shmInfo.shmaddr);
+}
+
 /**
  * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
- * │ This is the screenshot method. It uses Xlib.h to get X's display and root window and capture its content,        │
- * │ and Xutil only to call XDestroyImage and free the resources we used to grab the screenshot. XGetImage returns    │
- * │ image data using BGRX, so we must manually convert the image into RGBA to compose the image data to be used by   │
- * │ Raylib with the pixel format we need for our texture (uncompressed R8G8B8A8).                                    │
+ * │ MIT-SHM capture path. Instead of streaming the whole framebuffer through the X socket like XGetImage does, we    │
+ * │ create a SysV shared memory segment, let the X server attach to it, and ask the server to copy the root window   │
+ * │ straight into it. Returns nullptr whenever anything along the way is unavailable so the caller can fall back.    │
  * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
  */
-Image CaptureScreenX11(int x, int y, int width, int height) {
-  Display* display = XOpenDisplay(nullptr);
-  if (!display) {
-    std::cerr << "Cannot open X11 display!" << std::endl;
-    return {0};
+XImage* GrabImageXShm(Display* display, Window root, int x, int y, int width, int height, XShmSegmentInfo& shmInfo) {
+  if (!XShmQueryExtension(display)) return nullptr;
+
+  int screen = DefaultScreen(display);
+  XImage* img = XShmCreateImage(display, DefaultVisual(display, screen), DefaultDepth(display, screen), ZPixmap,
+                                nullptr, &shmInfo, width, height);
+  if (!img) return nullptr;
+
+  shmInfo.shmid = shmget(IPC_PRIVATE, img->bytes_per_line * img->height, IPC_CREAT | 0600);
+  if (shmInfo.shmid < 0) {
+    XDestroyImage(img);
+    return nullptr;
   }
-  Window root = DefaultRootWindow(display);
-  std::cout << "Root window: " << root << std::endl;
 
-  XSync(display, True);
-  XImage* img = XGetImage(display, root, x, y, width, height, AllPlanes, ZPixmap);
+  shmInfo.shmaddr = img->data = static_cast<char*>(shmat(shmInfo.shmid, nullptr, 0));
+  if (shmInfo.shmaddr == reinterpret_cast<char*>(-1)) {
+    shmctl(shmInfo.shmid, IPC_RMID, nullptr);
+    img->data = nullptr;
+    XDestroyImage(img);
+    return nullptr;
+  }
+  shmInfo.readOnly = False;
 
-  if (!img) {
-    std::cerr << "Failed to capture screen!" << std::endl;
-    return {0};
+  bool attachFailed = false;
+  {
+    std::lock_guard<std::mutex> lock(xShmAttachMutex);
+    xShmAttachFailed = false;
+    XErrorHandler previousHandler = XSetErrorHandler(HandleShmAttachError);
+    XShmAttach(display, &shmInfo);
+    XSync(display, False);
+    XSetErrorHandler(previousHandler);
+    attachFailed = xShmAttachFailed;
   }
 
-  // Allocate memory for the RGBA image
-  unsigned char* rgbaData = new unsigned char[width * height * 4];
+  // Mark the segment for removal right away, so it goes away with us even if we crash before cleaning up
+  shmctl(shmInfo.shmid, IPC_RMID, nullptr);
 
-  // Convert BGRX to RGBA
-  for (int i = 0; i < width * height; i++) {
-    int pixelIndex = i * 4;
-    rgbaData[pixelIndex + 0] = img->data[pixelIndex + 2];  // R
-    rgbaData[pixelIndex + 1] = img->data[pixelIndex + 1];  // G
-    rgbaData[pixelIndex + 2] = img->data[pixelIndex + 0];  // B
-    rgbaData[pixelIndex + 3] = 255;                        // Alpha (fully opaque)
+  if (attachFailed) {
+    img->data = nullptr;
+    XDestroyImage(img);
+    shmdt(shmInfo.shmaddr);
+    return nullptr;
   }
 
-  Image screenshot = {
-      .data = rgbaData, .width = width, .height = height, .mipmaps = 1, .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+  if (!XShmGetImage(display, root, img, x, y, AllPlanes)) {
+    ReleaseImageXShm(display, img, shmInfo);
+    return nullptr;
+  }
 
-  XDestroyImage(img);  // Free X11 image memory
-  return screenshot;
+  return img;
 }
 
 /**
  * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
- * │ This function helps us to control the "virtual camera" in regards to the pan, zoom, and the texture size limits. │
- * │ It prevents the camera from going beyond the texture limits when zoomed in (when the viewport is smaller than    │
- * │ the texture) and centers the texture when zoomed out (when the viewport is larger than the texture).             │
+ * │ Converts rows [rowBegin, rowEnd) of a BGRX XImage into an RGBA buffer using the fastest swizzle kernel the CPU   │
+ * │ supports. Both sides may have padded rows (XImage's bytes_per_line, or dstStride when we write into a region of  │
+ * │ a bigger image; 0 means tightly packed), so we only go pixel-contiguous across rows when neither has padding.    │
  * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
  */
-void ClampPan(Vector2& pan, float zoom, Vector2 textureSize, Vector2 screenSize) {
-  float visibleWidth = screenSize.x / zoom;
-  float visibleHeight = screenSize.y / zoom;
+void ConvertBGRXToRGBA(const XImage* img, unsigned char* rgbaData, int rowBegin, int rowEnd, size_t dstStride = 0) {
+  const size_t srcStride = img->bytes_per_line;
+  if (dstStride == 0) dstStride = static_cast<size_t>(img->width) * 4;
+  const unsigned char* src = reinterpret_cast<const unsigned char*>(img->data);
 
-  // center the zoomed out texture if smaller than the viewport
-  if (visibleWidth >= textureSize.x) {
-    pan.x = (textureSize.x - visibleWidth) / 2.0f;
-  } else {
-    pan.x = std::max(0.0f, std::min(pan.x, textureSize.x - visibleWidth));
+  if (srcStride == dstStride) {
+    SwizzleBGRXToRGBA(src + rowBegin * srcStride, rgbaData + rowBegin * dstStride,
+                      static_cast<size_t>(rowEnd - rowBegin) * img->width);
+    return;
   }
 
-  if (visibleHeight >= textureSize.y) {
-    pan.y = (textureSize.y - visibleHeight) / 2.0f;
-  } else {
-    pan.y = std::max(0.0f, std::min(pan.y, textureSize.y - visibleHeight));
+  for (int row = rowBegin; row < rowEnd; row++) {
+    SwizzleBGRXToRGBA(src + row * srcStride, rgbaData + row * dstStride, img->width);
   }
 }
 
 /**
  * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
- * │ This is a helper function that returns the mouse position coordinates in texture space. It considers our current │
- * │ pan and zoom to return exactly the X and Y coordinates of the texture pixel we have the mouse cursor on.         │
+ * │ A single core can't keep up with the memory bandwidth needed to convert a 100+ MB multi-monitor capture, so we   │
+ * │ split the image in row bands and convert them on the shared worker pool. Bands are kept at a megabyte or so at   │
+ * │ least, so small captures don't pay for the thread handoff. maxBands = 0 means one band per pool thread.          │
  * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
  */
-Vector2 GetMousePositionOnTexture(Vector2 mouseViewport, Vector2 pan, float zoom) {
-  return {(mouseViewport.x / zoom) + pan.x, (mouseViewport.y / zoom) + pan.y};
+void ConvertBGRXToRGBAParallel(const XImage* img, unsigned char* rgbaData, unsigned maxBands = 0,
+                               size_t dstStride = 0) {
+  const int minRowsPerBand = std::max(1, (1 << 20) / std::max(1, img->width * 4));
+  SharedWorkerPool().ParallelFor(
+      0, img->height,
+      [&](int rowBegin, int rowEnd) { ConvertBGRXToRGBA(img, rgbaData, rowBegin, rowEnd, dstStride); }, maxBands,
+      minRowsPerBand);
 }
 
 /**
  * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
- * │ This is a helper function that helps zooming with an aim. It takes our mouse position coordinates in texture     │
- * │ space, our previous zoom level (before triggering the mouse wheel event to zoom), our next zoom level (after     │
- * │ triggering the mouse wheel event), and our current pan coordinates. Then it computes the pan coordinates         │
- * │ so the texture pixel under our mouse cursor ends up being the same after zooming. Maybe there's a better way to  │
- * │ achieve the same, but that kinda works.                                                                          │
+ * │ The raw result of a capture: the BGRX XImage as X gave it to us, plus what we need to give it back afterwards.   │
  * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
  */
-Vector2 ComputeTargetPan(Vector2 mouseOnTexture, float previousZoom, float nextZoom, Vector2 currentPan) {
-  Vector2 targetPan;
-  targetPan.x = mouseOnTexture.x - ((mouseOnTexture.x - currentPan.x) * (previousZoom / nextZoom));
-  targetPan.y = mouseOnTexture.y - ((mouseOnTexture.y - currentPan.y) * (previousZoom / nextZoom));
-  return targetPan;
-}
-
-struct DebugInfo {
-  std::string label;
-  std::function<std::string()> valueFunc;
+struct ScreenCapture {
+  Display* display = nullptr;
+  XImage* image = nullptr;
+  XShmSegmentInfo shmInfo = {};
+  CaptureBackend backend = CaptureBackend::NONE;
 };
 
-enum class DebugAnchor { TOP_LEFT, TOP_RIGHT, BOTTOM_LEFT, BOTTOM_RIGHT };
+void ReleaseScreenCapture(ScreenCapture& capture) {
+  if (capture.image) {
+    if (capture.backend == CaptureBackend::XSHM) {
+      ReleaseImageXShm(capture.display, capture.image, capture.shmInfo);
+    } else {
+      XDestroyImage(capture.image);  // Free X11 image memory
+    }
+  }
+  if (capture.display) XCloseDisplay(capture.display);
+  capture = {};
+}
 
 /**
  * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
- * │ This is just a small class I'll use as a debug panel to show some values in real-time because I didn't want to   │
- * │ bloat such a minimal and simple app with any overkill stuff like Dear ImGui or any other sophisticated GUI       │
- * │ library. I don't want the debug info to be ugly tho, so I'm writing this.                                        │
+ * │ This is the screenshot method. It uses Xlib.h to get X's display and root window and capture its content,        │
+ * │ and Xutil only to call XDestroyImage and free the resources we used to grab the screenshot. We try the MIT-SHM   │
+ * │ extension first and fall back to plain XGetImage when it's missing (e.g. a remote DISPLAY). Either way the image │
+ * │ data comes back as BGRX and is handed over untouched; it's up to the caller to upload it as-is or convert it.    │
+ * │ The capture must be given back with ReleaseScreenCapture.                                                        │
  * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
  */
+bool CaptureScreenX11(int x, int y, int width, int height, ScreenCapture& capture) {
+  StartupProfiler::Scope phase(Profiler(), "CaptureScreenX11");
+  capture = {};
 
-class DebugPanel {
- public:
-  int x, y;
-  int fontSize;
-  float padding;
-  bool visible = false;
-  std::vector<DebugInfo> entries;
-  int longestEntryEver = 0;
-  Font myFont;
-  DebugAnchor anchor = DebugAnchor::TOP_LEFT;  // Default
-
-  DebugPanel(int startX, int startY, int textSize = 20, float spacingMultiplier = 1.0f)
-      : x(startX), y(startY), fontSize(textSize), padding(textSize * spacingMultiplier) {
-    myFont = LoadFontFromMemory(".ttf", monofont_ttf, monofont_ttf_len, fontSize, 0, 0);
-    if (myFont.texture.id == 0) {
-      std::cerr << "Failed to load embedded font from memory!" << std::endl;
-    } else {
-      std::cout << "Embedded font loaded successfully!" << std::endl;
-    }
+  Profiler().Begin("XOpenDisplay");
+  capture.display = XOpenDisplay(nullptr);
+  Profiler().End();
+  if (!capture.display) {
+    std::cerr << "Cannot open X11 display!" << std::endl;
+    return false;
   }
+  Window root = DefaultRootWindow(capture.display);
+  std::cout << "Root window: " << root << std::endl;
 
-  void SetAnchor(DebugAnchor newAnchor) { anchor = newAnchor; }
-
-  void Dispose() { UnloadFont(myFont); }
+  Profiler().Begin("XSync");
+  XSync(capture.display, True);
+  Profiler().End();
 
-  void AddEntry(const std::string& label, std::function<std::string()> valueFunc) {
-    entries.push_back({label, valueFunc});
+  capture.backend = CaptureBackend::XSHM;
+  Profiler().Begin("XShmGetImage");
+  capture.image = GrabImageXShm(capture.display, root, x, y, width, height, capture.shmInfo);
+  Profiler().End();
+  if (!capture.image) {
+    capture.backend = CaptureBackend::XGETIMAGE;
+    Profiler().Begin("XGetImage");
+    capture.image = XGetImage(capture.display, root, x, y, width, height, AllPlanes, ZPixmap);
+    Profiler().End();
   }
 
-  void SetVisible(bool isVisible) { visible = isVisible; }
+  if (!capture.image) {
+    std::cerr << "Failed to capture screen!" << std::endl;
+    ReleaseScreenCapture(capture);
+    return false;
+  }
+  std::cout << "Capture backend: " << CaptureBackendName(capture.backend) << std::endl;
 
-  void Draw() {
-    if (!visible) return;
+  return true;
+}
 
-    int entriesSize = entries.size();
-    int longestEntryWidth = 0;
-    for (const auto& entry : entries) {
-      std::string text = entry.label + ": " + entry.valueFunc();
-      int width = MeasureText(text.c_str(), fontSize) - fontSize;
-      longestEntryWidth = std::max(longestEntryWidth, width);
-      longestEntryEver = std::max(longestEntryEver, width);
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ GPU path: texture swizzling (core since GL 3.3 / GLES 3.0, or through ARB/EXT_texture_swizzle) lets the sampler  │
+ * │ reorder channels for us. We upload the BGRX bytes as if they were RGBA and tell GL to read R from B, B from R    │
+ * │ and to return 1 for alpha, so neither the conversion pass nor the second 4 bytes/pixel buffer are needed.        │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+bool SupportsTextureSwizzle() {
+  switch (rlGetVersion()) {
+    case RL_OPENGL_33:
+    case RL_OPENGL_43:
+    case RL_OPENGL_ES_30:
+      return true;
+    case RL_OPENGL_21: {
+      const char* extensions = reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS));
+      return extensions && (std::strstr(extensions, "GL_ARB_texture_swizzle") ||
+                            std::strstr(extensions, "GL_EXT_texture_swizzle"));
     }
+    default:
+      return false;
+  }
+}
 
-    float pad = fontSize * 0.5f;
-    int panelWidth = longestEntryEver + fontSize;
-    int panelHeight = padding * entries.size() + fontSize;
-
-    // Compute screen bounds
-    int screenWidth = GetScreenWidth();
-    int screenHeight = GetScreenHeight();
+// Allocates an (uninitialized) texture that stores BGRX bytes as they come from X and samples them as RGBA
+Texture2D LoadBGRXTexture(int width, int height) {
+  unsigned int id = rlLoadTexture(nullptr, width, height, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8, 1);
+  if (id == 0) return {0};
 
-    // Determine the actual X and Y based on the anchor
-    int adjustedX = x;
-    int adjustedY = y;
+  glBindTexture(GL_TEXTURE_2D, id);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_BLUE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_A, GL_ONE);
+  glBindTexture(GL_TEXTURE_2D, 0);
 
-    switch (anchor) {
-      case DebugAnchor::TOP_LEFT:
-        break;  // Keep default X and Y
-      case DebugAnchor::TOP_RIGHT:
-        adjustedX = screenWidth - panelWidth - x + fontSize;
-        break;
-      case DebugAnchor::BOTTOM_LEFT:
-        adjustedY = screenHeight - panelHeight - y + fontSize;
-        break;
-      case DebugAnchor::BOTTOM_RIGHT:
-        adjustedX = screenWidth - panelWidth - x + fontSize;
-        adjustedY = screenHeight - panelHeight - y + fontSize;
-        break;
-    }
+  return {id, width, height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+}
 
-    int left = adjustedX - pad;
-    int top = adjustedY - pad;
-    int right = adjustedX + longestEntryEver + pad;
-    int bottom = adjustedY + padding * entriesSize + pad;
+// UpdateTextureRec for pixels whose rows are rowLength pixels long, so a region of a bigger buffer (or a padded
+// XImage) can be uploaded without first copying it out into a tightly packed one
+void UpdateTextureRecStrided(Texture2D texture, Rectangle rec, const void* pixels, int rowLength) {
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, rowLength);
+  UpdateTextureRec(texture, rec, pixels);
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+}
 
-    DrawRectangle(left, top, panelWidth, panelHeight, Fade(BLACK, 0.6667f));
-    DrawLine(left, top, right, top, WHITE);        // top
-    DrawLine(left, top, left, bottom, WHITE);      // left
-    DrawLine(right, top, right, bottom, WHITE);    // right
-    DrawLine(left, bottom, right, bottom, WHITE);  // bottom
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ What we do with the CPU-side RGBA copy of the desktop once it is on the GPU. On a triple-4K setup that copy is   │
+ * │ ~100 MB that nothing needs while we're just zooming around, so by default it is dropped right after upload and   │
+ * │ features that want CPU pixels read them back from the texture when they ask. "compressed" keeps a deflated copy  │
+ * │ (in row strips, so a streamed-in region only recompresses the strips it touches) and "full" keeps all of it.     │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+enum class CaptureMemory { DROP, COMPRESSED, FULL };
 
-    float yOffset = adjustedY;
-    for (const auto& entry : entries) {
-      std::string text = entry.label + ": " + entry.valueFunc();
-      DrawTextEx(myFont, text.c_str(), {static_cast<float>(adjustedX), yOffset}, fontSize, 0, WHITE);
-      yOffset += padding;
-    }
+const char* CaptureMemoryName(CaptureMemory policy) {
+  switch (policy) {
+    case CaptureMemory::DROP:
+      return "drop";
+    case CaptureMemory::COMPRESSED:
+      return "compressed";
+    case CaptureMemory::FULL:
+      return "full";
   }
-};
+  return "unknown";
+}
 
-void SetupUTF8() { std::locale::global(std::locale("en_US.UTF-8")); }
+std::optional<CaptureMemory> ParseCaptureMemory(const std::string& name) {
+  if (name == "drop") return CaptureMemory::DROP;
+  if (name == "compressed") return CaptureMemory::COMPRESSED;
+  if (name == "full") return CaptureMemory::FULL;
+  return std::nullopt;
+}
 
-void DrawMonitorLayout(const MonitorState& monitorState) {
-  SetupUTF8();
+// Tightly packed RGBA copy of the whole desktop texture, handed out to whoever needs CPU pixels
+struct DesktopPixels {
+  int width = 0;
+  int height = 0;
+  std::vector<unsigned char> rgba;
+};
 
-  // Get terminal width
-  struct winsize w;
-  ioctl(STDOUT_FILENO, TIOCGWINSZ, &w);
-  int termWidth = w.ws_col - 4;
+class RetainedPixels {
+ public:
+  static constexpr int STRIP_ROWS = 64;
 
-  if (termWidth <= 0) {
-    std::cerr << "Unable to detect terminal width!" << std::endl;
-    return;
+  void Reset(CaptureMemory newPolicy, int newWidth, int newHeight) {
+    policy = newPolicy;
+    width = newWidth;
+    height = newHeight;
+    full.clear();
+    full.shrink_to_fit();
+    strips.clear();
+    if (policy == CaptureMemory::FULL) full.assign(static_cast<size_t>(width) * height * 4, 0);
+    if (policy == CaptureMemory::COMPRESSED) strips.resize((height + STRIP_ROWS - 1) / STRIP_ROWS);
   }
 
-  int monitorCount = monitorState.spatialMonitorIndexes.size();
-  if (monitorCount == 0) {
-    std::cerr << "No monitors detected!" << std::endl;
-    return;
-  }
+  // Stores an RGBA region whose rows are srcStride bytes apart
+  void Store(Rectangle rec, const unsigned char* rgba, size_t srcStride) {
+    const int x = static_cast<int>(rec.x);
+    const int y = static_cast<int>(rec.y);
+    const int w = static_cast<int>(rec.width);
+    const int h = static_cast<int>(rec.height);
+    const size_t rowBytes = static_cast<size_t>(w) * 4;
 
-  // Determine total pixel width of all monitors
-  float totalWidthPixels = 0;
-  for (int idx : monitorState.spatialMonitorIndexes) {
-    totalWidthPixels += monitorState.resolutions[idx].x;
+    if (policy == CaptureMemory::FULL) {
+      for (int row = 0; row < h; row++) {
+        std::memcpy(full.data() + ((static_cast<size_t>(y) + row) * width + x) * 4, rgba + row * srcStride, rowBytes);
+      }
+    } else if (policy == CaptureMemory::COMPRESSED) {
+      std::vector<unsigned char> strip;
+      for (int index = y / STRIP_ROWS; index <= (y + h - 1) / STRIP_ROWS; index++) {
+        const int stripY = index * STRIP_ROWS;
+        const int stripRows = std::min(STRIP_ROWS, height - stripY);
+        DecompressStrip(index, stripRows, strip);
+        for (int row = std::max(y, stripY); row < std::min(y + h, stripY + stripRows); row++) {
+          std::memcpy(strip.data() + (static_cast<size_t>(row - stripY) * width + x) * 4,
+                      rgba + (row - y) * srcStride, rowBytes);
+        }
+        CompressStrip(index, strip);
+      }
+    }
   }
 
-  // Compute proportional width of each monitor box
-  std::vector<int> boxWidths(monitorCount);
-  std::vector<int> boxHeights(monitorCount);
-  float scaleFactor = static_cast<float>(termWidth) / totalWidthPixels;
+  // Whole-desktop RGBA copy, or nothing if this policy doesn't retain pixels
+  bool Restore(DesktopPixels& pixels) const {
+    if (policy == CaptureMemory::DROP) return false;
+    pixels.width = width;
+    pixels.height = height;
+    if (policy == CaptureMemory::FULL) {
+      pixels.rgba = full;
+      return true;
+    }
 
-  int maxBoxHeight = 10;  // Fixed height for boxes
-  for (int i = 0; i < monitorCount; i++) {
-    int realIndex = monitorState.spatialMonitorIndexes[i];  // Real index
-    boxWidths[i] = std::max(10, static_cast<int>(monitorState.resolutions[realIndex].x * scaleFactor));
-    boxHeights[i] = maxBoxHeight;
+    pixels.rgba.resize(static_cast<size_t>(width) * height * 4);
+    std::vector<unsigned char> strip;
+    for (size_t index = 0; index < strips.size(); index++) {
+      const int stripRows = std::min<int>(STRIP_ROWS, height - index * STRIP_ROWS);
+      DecompressStrip(index, stripRows, strip);
+      std::memcpy(pixels.rgba.data() + index * STRIP_ROWS * width * 4, strip.data(), strip.size());
+    }
+    return true;
   }
 
-  // Define Unicode box-drawing characters as UTF-8 strings
-  const std::string topLeft = "┌";
-  const std::string topRight = "┐";
-  const std::string bottomLeft = "└";
-  const std::string bottomRight = "┘";
-  const std::string horizontal = "─";
-  const std::string vertical = "│";
+  size_t Bytes() const {
+    size_t bytes = full.size();
+    for (const auto& strip : strips) bytes += strip.size();
+    return bytes;
+  }
 
-  // Draw monitor layout to the terminal
-  for (int row = 0; row < maxBoxHeight; row++) {
-    std::string line;
-    for (int i = 0; i < monitorCount; i++) {
-      int realIndex = monitorState.spatialMonitorIndexes[i];  // Get real index in order
-      std::string resolutionLabel = std::to_string(static_cast<int>(monitorState.resolutions[realIndex].x)) + "x" +
-                                    std::to_string(static_cast<int>(monitorState.resolutions[realIndex].y));
+ private:
+  CaptureMemory policy = CaptureMemory::DROP;
+  int width = 0;
+  int height = 0;
+  std::vector<unsigned char> full;
+  std::vector<std::vector<unsigned char>> strips;  // deflated; empty means not captured yet (all zeros)
 
-      std::string spatialIndexLabel = "[" + std::to_string(i) + "]";  // Spatial index for ordering
+  void DecompressStrip(size_t index, int stripRows, std::vector<unsigned char>& strip) const {
+    strip.assign(static_cast<size_t>(width) * stripRows * 4, 0);
+    if (strips[index].empty()) return;
 
-      int padding = boxWidths[i] - 2 - resolutionLabel.size();
-      int bottomPadding = boxWidths[i] - 2 - spatialIndexLabel.size();
+    int size = 0;
+    unsigned char* data = DecompressData(strips[index].data(), strips[index].size(), &size);
+    if (data == nullptr) return;
+    std::memcpy(strip.data(), data, std::min<size_t>(size, strip.size()));
+    MemFree(data);
+  }
 
-      if (row == 0) {  // Top border
-        line += topLeft + resolutionLabel;
-        for (int j = 0; j < padding; j++) {
-          line += horizontal;
-        }
-        line += topRight + " ";
-      } else if (row == maxBoxHeight - 1) {  // Bottom border with spatial index
-        line += bottomLeft + spatialIndexLabel;
-        for (int j = 0; j < bottomPadding; j++) {
-          line += horizontal;
-        }
-        line += bottomRight + " ";
-      } else {  // Empty box space
-        line += vertical + std::string(boxWidths[i] - 2, ' ') + vertical + " ";
-      }
+  void CompressStrip(size_t index, const std::vector<unsigned char>& strip) {
+    int size = 0;
+    unsigned char* data = CompressData(strip.data(), strip.size(), &size);
+    if (data == nullptr) {
+      strips[index].clear();
+      return;
     }
-    std::cout << line << std::endl;
+    strips[index].assign(data, data + size);
+    MemFree(data);
   }
-  std::cout.flush();
+};
+
+// Largest texture the driver takes, possibly lowered from the command line (--max-texture-size) to exercise tiling
+int MaxTextureSize(int limit) {
+  GLint maxSize = 0;
+  glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+  if (maxSize <= 0) maxSize = 4096;  // the minimum any GL 3.x driver has to support
+  return limit > 0 ? std::min<int>(limit, maxSize) : maxSize;
 }
 
-int main(int argc, char* argv[]) {
-  const int fontSize = 16;
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ Owns the desktop texture(s). Storage is allocated once for the whole virtual desktop and then filled region by   │
+ * │ region, so the monitor the user looks at can be shown before the rest has even been captured. Later activations  │
+ * │ of a same-sized desktop (daemon mode) reuse it in place, so we don't reallocate a 100 MB texture every time the  │
+ * │ hotkey is pressed. CPU-side pixels are only kept as the capture memory policy says (see CaptureMemory above).    │
+ * │ A desktop that fits in GL_MAX_TEXTURE_SIZE gets a single texture. A bigger one (four 4K monitors side by side    │
+ * │ are 15360 px wide, and some drivers stop at 8192) is split into fixed-size tiles that are uploaded and drawn     │
+ * │ separately; Draw only touches the tiles that intersect the visible source rectangle.                             │
+ * │ Zoomed in, tiles are point sampled so every desktop pixel stays a crisp square. Zoomed out (down to 0.1x), point │
+ * │ sampling aliases badly and reads the texture at a stride that trashes the texture cache, so visible tiles switch │
+ * │ to trilinear filtering over mipmaps. Mipmaps are only (re)generated right before a stale tile is drawn zoomed    │
+ * │ out, so uploads (streamed regions, live updates) stay cheap while zoomed in.                                     │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+class DesktopTexture {
+ public:
+  struct Tile {
+    Texture2D texture;
+    Rectangle rec;  // in desktop coordinates
+    bool mipmapsStale = true;
+    TextureFilter filter = TEXTURE_FILTER_POINT;
+  };
 
-  int screenWidth = 640;
-  int screenHeight = 480;
+  static constexpr int TILE_SIZE = 4096;
 
-  float zoom = 1.0f;
-  float targetZoom = 1.0f;
-  const float minZoom = 0.1f;
-  const float maxZoom = 300.0f;
-  const float smoothingFactor = 7.5f;
+  std::vector<Tile> tiles;
+  int width = 0;
+  int height = 0;
+  bool gpuSwizzle = false;
+  const char* uploadPath = "none";
+  CaptureMemory memoryPolicy = CaptureMemory::DROP;
+  int maxTextureSize = 0;  // 0 means whatever the driver supports
 
-  bool dragging = false;
-  Vector2 pan = {0, 0};
-  Vector2 targetPan = {0, 0};
+  bool Allocate(int newWidth, int newHeight, bool allowGpuSwizzle) {
+    // Upload the BGRX pixels untouched and let the GPU swizzle them, unless the driver can't (or we're told not to)
+    bool wantGpuSwizzle = allowGpuSwizzle && SupportsTextureSwizzle();
+    retained.Reset(memoryPolicy, newWidth, newHeight);
+    generation++;
+    if (!tiles.empty() && width == newWidth && height == newHeight && gpuSwizzle == wantGpuSwizzle) return true;
 
-  Vector2 mousePosition = {0, 0};
-  Vector2 previousMousePosition = {0, 0};
-  Vector2 mouseOnTexture = {0, 0};
+    StartupProfiler::Scope phase(Profiler(), "Texture allocation");
+    Unload();
+    width = newWidth;
+    height = newHeight;
 
-  float deltaTime = 0.0f;
-  int fps = 0.0f;
+    const int maxSize = MaxTextureSize(maxTextureSize);
+    const bool single = width <= maxSize && height <= maxSize;
+    const int tileWidth = single ? width : std::min(TILE_SIZE, maxSize);
+    const int tileHeight = single ? height : std::min(TILE_SIZE, maxSize);
 
-  SetConfigFlags(FLAG_WINDOW_HIDDEN);
-  InitWindow(screenWidth, screenHeight, "urblind");
+    gpuSwizzle = wantGpuSwizzle;
+    for (int y = 0; y < height; y += tileHeight) {
+      for (int x = 0; x < width; x += tileWidth) {
+        Tile tile;
+        tile.rec = {static_cast<float>(x), static_cast<float>(y), static_cast<float>(std::min(tileWidth, width - x)),
+                    static_cast<float>(std::min(tileHeight, height - y))};
+        if (!AllocateTile(tile)) {
+          Unload();
+          return false;
+        }
+        tiles.push_back(tile);
+      }
+    }
+    uploadPath = gpuSwizzle ? "GPU swizzle" : "CPU swizzle";
+    std::cout << "Texture upload: " << uploadPath << " | " << tiles.size() << (single ? " texture" : " tiles")
+              << std::endl;
 
-  DebugPanel debugPanel(12, 12, fontSize, 1.0f);
-  debugPanel.AddEntry("fps    ", [&]() { return TextFormat("%d", fps); });
-  debugPanel.AddEntry("mouse  ", [&]() { return TextFormat("%05.0f, %05.0f", mousePosition.x, mousePosition.y); });
-  debugPanel.AddEntry("texure ", [&]() { return TextFormat("%05.0f, %05.0f", mouseOnTexture.x, mouseOnTexture.y); });
-  debugPanel.AddEntry("pan    ", [&]() { return TextFormat("%05.0f, %05.0f", pan.x, pan.y); });
-  debugPanel.AddEntry("zoom   ", [&]() { return TextFormat("%.2f", zoom); });
+    // The mirrored repeat around the desktop only makes sense (and only works) with a single texture
+    for (Tile& tile : tiles) {
+      SetTextureWrap(tile.texture, single ? TEXTURE_WRAP_MIRROR_REPEAT : TEXTURE_WRAP_CLAMP);
+      SetTextureFilter(tile.texture, TEXTURE_FILTER_POINT);
+    }
+    return true;
+  }
 
-  MonitorState monitorState;
+  // Puts a capture of the desktop region starting at (x, y) into the texture
+  bool UploadCapture(const XImage* img, int x, int y) {
+    StartupProfiler::Scope phase(Profiler(), "Texture upload");
+    if (img->bits_per_pixel != 32) {
+      std::cerr << "Unsupported capture format: " << img->bits_per_pixel << " bits per pixel" << std::endl;
+      return false;
+    }
+    Rectangle rec = {static_cast<float>(x), static_cast<float>(y), static_cast<float>(img->width),
+                     static_cast<float>(img->height)};
+    generation++;
 
-  int selectedMonitor = -1;
+    if (gpuSwizzle) {
+      UploadRegion(rec, reinterpret_cast<const unsigned char*>(img->data), img->bytes_per_line / 4);
+      if (memoryPolicy == CaptureMemory::DROP) return true;
+    }
 
-  bool debugMode = false;
-  std::optional<DebugAnchor> debugAnchor;
+    // Convert the BGRX capture into RGBA, either because the texture wants it (CPU path) or to retain a copy. The
+    // buffer only lives until the region is uploaded and/or retained.
+    Profiler().Begin("BGRX to RGBA conversion");
+    std::vector<unsigned char> rgba(static_cast<size_t>(img->width) * img->height * 4);
+    ConvertBGRXToRGBAParallel(img, rgba.data());
+    Profiler().End();
+    if (!gpuSwizzle) UploadRegion(rec, rgba.data(), img->width);
+    retained.Store(rec, rgba.data(), static_cast<size_t>(img->width) * 4);
+    return true;
+  }
 
-  // First pass: Parse all flags and options
-  for (int i = 1; i < argc; i++) {
-    std::string arg = argv[i];
+  // Same, for pixels that are already tightly packed in the texture's own channel order (see BackgroundCapture)
+  void UploadPixels(Rectangle rec, const unsigned char* pixels) {
+    UploadRegion(rec, pixels, static_cast<int>(rec.width));
+    generation++;
+    if (memoryPolicy == CaptureMemory::DROP) return;
+
+    const size_t rowBytes = static_cast<size_t>(rec.width) * 4;
+    if (!gpuSwizzle) {
+      retained.Store(rec, pixels, rowBytes);
+      return;
+    }
+    std::vector<unsigned char> rgba(rowBytes * static_cast<size_t>(rec.height));
+    SwizzleBGRXToRGBA(pixels, rgba.data(), rgba.size() / 4);
+    retained.Store(rec, rgba.data(), rowBytes);
+  }
+
+  // Drop-in for DrawTexturePro(texture, source, dest, {0, 0}, 0, tint), with source in desktop coordinates
+  void Draw(Rectangle source, Rectangle dest, Color tint) {
+    const float scaleX = dest.width / source.width;
+    const float scaleY = dest.height / source.height;
+    const bool minified = scaleX < 1.0f;
+
+    if (tiles.size() == 1) {
+      PrepareFilter(tiles[0], minified);
+      DrawTexturePro(tiles[0].texture, source, dest, {0, 0}, 0, tint);
+      return;
+    }
+
+    for (Tile& tile : tiles) {
+      if (!CheckCollisionRecs(source, tile.rec)) continue;
+      PrepareFilter(tile, minified);
+      Rectangle visible = GetCollisionRec(source, tile.rec);
+      Rectangle tileSource = {visible.x - tile.rec.x, visible.y - tile.rec.y, visible.width, visible.height};
+      Rectangle tileDest = {dest.x + (visible.x - source.x) * scaleX, dest.y + (visible.y - source.y) * scaleY,
+                            visible.width * scaleX, visible.height * scaleY};
+      DrawTexturePro(tile.texture, tileSource, tileDest, {0, 0}, 0, tint);
+    }
+  }
+
+  /**
+   * ┌────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+   * │ CPU pixels for color readback, export and the like. Comes from the retained copy if the policy keeps one, or   │
+   * │ is read back from the GPU otherwise. The result is shared while the texture doesn't change, and freed as soon  │
+   * │ as the last user lets go of it.                                                                                │
+   * └────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+   */
+  std::shared_ptr<const DesktopPixels> Pixels() {
+    std::shared_ptr<const DesktopPixels> pixels = shared.lock();
+    if (pixels && sharedGeneration == generation) return pixels;
+    if (tiles.empty()) return nullptr;
+
+    auto fresh = std::make_shared<DesktopPixels>();
+    if (!retained.Restore(*fresh)) ReadBack(*fresh);
+    shared = fresh;
+    sharedGeneration = generation;
+    return fresh;
+  }
+
+  // Just the pixels inside region (whole desktop pixels, see ClipToPixels), tightly packed. Cut out of the current
+  // snapshot when someone holds one, otherwise read back from the part of each tile the region covers, so exporting
+  // the view doesn't pay for a readback of the whole desktop.
+  std::shared_ptr<const DesktopPixels> PixelsIn(Rectangle region) {
+    if (tiles.empty() || region.width <= 0 || region.height <= 0) return nullptr;
+    auto pixels = std::make_shared<DesktopPixels>();
+    pixels->width = static_cast<int>(region.width);
+    pixels->height = static_cast<int>(region.height);
+    pixels->rgba.resize(static_cast<size_t>(pixels->width) * pixels->height * 4);
+
+    std::shared_ptr<const DesktopPixels> whole = shared.lock();
+    if (!whole || sharedGeneration != generation) {
+      ReadBackRegion(region, *pixels);
+      return pixels;
+    }
+    const size_t rowBytes = static_cast<size_t>(pixels->width) * 4;
+    for (int row = 0; row < pixels->height; row++) {
+      const size_t y = static_cast<size_t>(region.y) + row;
+      std::memcpy(pixels->rgba.data() + row * rowBytes,
+                  whole->rgba.data() + (y * whole->width + static_cast<size_t>(region.x)) * 4, rowBytes);
+    }
+    return pixels;
+  }
+
+  // Bytes of CPU memory spent on keeping pixels around (not counting a snapshot someone is holding on to)
+  size_t RetainedBytes() const { return retained.Bytes(); }
+
+  // Changes whenever the texture's contents do
+  unsigned Generation() const { return generation; }
+
+  void Unload() {
+    for (Tile& tile : tiles) UnloadTexture(tile.texture);
+    tiles.clear();
+    width = 0;
+    height = 0;
+    gpuSwizzle = false;
+    retained.Reset(memoryPolicy, 0, 0);
+    generation++;
+  }
+
+ private:
+  RetainedPixels retained;
+  std::weak_ptr<const DesktopPixels> shared;
+  unsigned generation = 0;
+  unsigned sharedGeneration = 0;
+
+  bool AllocateTile(Tile& tile) {
+    const int tileWidth = static_cast<int>(tile.rec.width);
+    const int tileHeight = static_cast<int>(tile.rec.height);
+    if (gpuSwizzle) {
+      tile.texture = LoadBGRXTexture(tileWidth, tileHeight);
+    } else {
+      tile.texture = {rlLoadTexture(nullptr, tileWidth, tileHeight, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8, 1), tileWidth,
+                      tileHeight, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+    }
+    if (tile.texture.id == 0) {
+      std::cerr << "Failed to allocate a " << tileWidth << "x" << tileHeight << " texture" << std::endl;
+      return false;
+    }
+    return true;
+  }
+
+  // Uploads a desktop region whose rows are rowLength pixels apart into every tile it overlaps
+  void UploadRegion(Rectangle rec, const unsigned char* pixels, int rowLength) {
+    for (Tile& tile : tiles) {
+      if (!CheckCollisionRecs(rec, tile.rec)) continue;
+      Rectangle part = GetCollisionRec(rec, tile.rec);
+      const unsigned char* start =
+          pixels + (static_cast<size_t>(part.y - rec.y) * rowLength + static_cast<size_t>(part.x - rec.x)) * 4;
+      UpdateTextureRecStrided(tile.texture, {part.x - tile.rec.x, part.y - tile.rec.y, part.width, part.height}, start,
+                              rowLength);
+      tile.mipmapsStale = true;
+    }
+  }
+
+  // Trilinear over fresh mipmaps when the tile is drawn smaller than 1:1, point sampling otherwise
+  static void PrepareFilter(Tile& tile, bool minified) {
+    if (minified && tile.mipmapsStale) {
+      GenTextureMipmaps(&tile.texture);
+      tile.mipmapsStale = false;
+    }
+    TextureFilter filter = minified ? TEXTURE_FILTER_TRILINEAR : TEXTURE_FILTER_POINT;
+    if (filter == tile.filter) return;
+    SetTextureFilter(tile.texture, filter);
+    tile.filter = filter;
+  }
+
+  void ReadBack(DesktopPixels& pixels) const {
+    StartupProfiler::Scope phase(Profiler(), "Texture readback");
+    pixels.width = width;
+    pixels.height = height;
+    pixels.rgba.resize(static_cast<size_t>(width) * height * 4);
+
+    for (const Tile& tile : tiles) {
+      const Texture2D& texture = tile.texture;
+      // Reading a texture gives back what is stored, not what the swizzle makes the shaders see
+      auto* stored =
+          static_cast<unsigned char*>(rlReadTexturePixels(texture.id, texture.width, texture.height, texture.format));
+      if (stored == nullptr) continue;
+      for (int row = 0; row < texture.height; row++) {
+        const unsigned char* src = stored + static_cast<size_t>(row) * texture.width * 4;
+        unsigned char* dst = pixels.rgba.data() +
+                             ((static_cast<size_t>(tile.rec.y) + row) * width + static_cast<size_t>(tile.rec.x)) * 4;
+        if (gpuSwizzle) {
+          SwizzleBGRXToRGBA(src, dst, texture.width);
+        } else {
+          std::memcpy(dst, src, static_cast<size_t>(texture.width) * 4);
+        }
+      }
+      MemFree(stored);
+    }
+  }
+
+  // Reads region of the desktop into pixels, which is exactly its size, through a framebuffer that each overlapping
+  // tile is attached to in turn (GL 3.3 can't read part of a texture directly)
+  void ReadBackRegion(Rectangle region, DesktopPixels& pixels) const {
+    StartupProfiler::Scope phase(Profiler(), "Texture readback");
+    const unsigned int framebuffer = rlLoadFramebuffer();
+    if (framebuffer == 0) return;
+
+    std::vector<unsigned char> stored(pixels.rgba.size());
+    glPixelStorei(GL_PACK_ROW_LENGTH, pixels.width);
+    for (const Tile& tile : tiles) {
+      if (!CheckCollisionRecs(region, tile.rec)) continue;
+      Rectangle part = GetCollisionRec(region, tile.rec);
+      rlFramebufferAttach(framebuffer, tile.texture.id, RL_ATTACHMENT_COLOR_CHANNEL0, RL_ATTACHMENT_TEXTURE2D, 0);
+      if (!rlFramebufferComplete(framebuffer)) continue;
+      rlEnableFramebuffer(framebuffer);
+      unsigned char* dst = stored.data() + (static_cast<size_t>(part.y - region.y) * pixels.width +
+                                            static_cast<size_t>(part.x - region.x)) * 4;
+      glReadPixels(static_cast<int>(part.x - tile.rec.x), static_cast<int>(part.y - tile.rec.y),
+                   static_cast<int>(part.width), static_cast<int>(part.height), GL_RGBA, GL_UNSIGNED_BYTE, dst);
+    }
+    glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+    rlDisableFramebuffer();
+    rlUnloadFramebuffer(framebuffer);
+
+    // Like ReadBack, this gets what is stored, which the GPU swizzle path keeps as BGRX
+    if (gpuSwizzle) {
+      SwizzleBGRXToRGBA(stored.data(), pixels.rgba.data(), stored.size() / 4);
+    } else {
+      pixels.rgba.swap(stored);
+    }
+  }
+};
+
+struct CapturePatch {
+  Rectangle rec;                      // where it goes, in desktop (= texture) coordinates
+  std::vector<unsigned char> pixels;  // tightly packed, already in the texture's channel order
+};
+
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ Captures a list of desktop regions on its own thread (CaptureScreenX11 opens its own X connection every time)    │
+ * │ while the render loop is already running, converting them for the CPU swizzle path if needed. Finished regions   │
+ * │ are queued up and the render loop merges them into the desktop texture with UpdateTextureRec as they arrive.     │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+class BackgroundCapture {
+ public:
+  ~BackgroundCapture() { Stop(); }
+
+  void Start(std::vector<Rectangle> regions, bool convertToRGBA) {
+    Stop();
+    cancelled = false;
+    remaining = static_cast<int>(regions.size());
+    thread = std::thread([this, regions = std::move(regions), convertToRGBA]() {
+      for (const Rectangle& rec : regions) {
+        if (cancelled) break;
+        CapturePatch patch;
+        if (CaptureRegion(rec, convertToRGBA, patch)) {
+          std::lock_guard<std::mutex> lock(mutex);
+          ready.push_back(std::move(patch));
+        } else {
+          remaining--;
+        }
+        glfwPostEmptyEvent();
+      }
+    });
+  }
+
+  // Non-blocking; hands over the next finished region, if any
+  bool TakePatch(CapturePatch& patch) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (ready.empty()) return false;
+    patch = std::move(ready.front());
+    ready.pop_front();
+    remaining--;
+    return true;
+  }
+
+  // Regions not merged into the texture yet
+  int Remaining() const { return remaining; }
+
+  void Stop() {
+    cancelled = true;
+    if (thread.joinable()) thread.join();
+    ready.clear();
+    remaining = 0;
+  }
+
+ private:
+  std::thread thread;
+  std::mutex mutex;
+  std::deque<CapturePatch> ready;
+  std::atomic<bool> cancelled{false};
+  std::atomic<int> remaining{0};
+
+  static bool CaptureRegion(Rectangle rec, bool convertToRGBA, CapturePatch& patch) {
+    ScreenCapture capture;
+    if (!CaptureScreenX11(rec.x, rec.y, rec.width, rec.height, capture)) return false;
+
+    const XImage* img = capture.image;
+    const size_t rowBytes = static_cast<size_t>(img->width) * 4;
+    patch.rec = rec;
+    patch.pixels.resize(rowBytes * img->height);
+    if (convertToRGBA) {
+      ConvertBGRXToRGBAParallel(img, patch.pixels.data());
+    } else {
+      for (int row = 0; row < img->height; row++) {
+        std::memcpy(patch.pixels.data() + row * rowBytes, img->data + row * img->bytes_per_line, rowBytes);
+      }
+    }
+
+    ReleaseScreenCapture(capture);
+    return true;
+  }
+};
+
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ rec minus hole, as up to four rectangles (bands above and below the hole, then the parts left and right of it).  │
+ * │ Together with their intersection they cover every pixel of rec exactly once.                                     │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+std::vector<Rectangle> SubtractRectangle(Rectangle rec, Rectangle hole) {
+  const float left = std::max(rec.x, std::min(hole.x, rec.x + rec.width));
+  const float right = std::max(left, std::min(hole.x + hole.width, rec.x + rec.width));
+  const float top = std::max(rec.y, std::min(hole.y, rec.y + rec.height));
+  const float bottom = std::max(top, std::min(hole.y + hole.height, rec.y + rec.height));
+
+  std::vector<Rectangle> regions;
+  auto add = [&](Rectangle part) {
+    if (part.width > 0 && part.height > 0) regions.push_back(part);
+  };
+  add({rec.x, rec.y, rec.width, top - rec.y});
+  add({rec.x, bottom, rec.width, rec.y + rec.height - bottom});
+  add({rec.x, top, left - rec.x, bottom - top});
+  add({right, top, rec.x + rec.width - right, bottom - top});
+  return regions;
+}
+
+// The virtual desktop minus the given monitor
+std::vector<Rectangle> DesktopRegionsAround(Rectangle monitor, int totalWidth, int totalHeight) {
+  return SubtractRectangle({0, 0, static_cast<float>(totalWidth), static_cast<float>(totalHeight)}, monitor);
+}
+
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ Single-producer / single-consumer triple buffer. The producer always has a back slot to fill and the consumer    │
+ * │ a front slot to read; publishing and picking up just swap slot indexes with the shared middle slot through one   │
+ * │ atomic, so neither side ever waits for the other. If the producer publishes again before the consumer picked up  │
+ * │ the previous one, that older one is dropped (and handed back to the producer to deal with).                      │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+template <typename T>
+class TripleBuffer {
+ public:
+  T& Back() { return slots[back]; }
+
+  // Publishes the back slot. Returns true if this replaced a published slot the consumer never saw, which is then
+  // the new back slot, so the producer can still look at what was dropped.
+  bool Publish() {
+    unsigned char previous = middle.exchange(static_cast<unsigned char>(back | FRESH), std::memory_order_acq_rel);
+    back = previous & INDEX;
+    return (previous & FRESH) != 0;
+  }
+
+  // Picks up the latest published slot, if there is one the consumer hasn't seen yet
+  T* Take() {
+    if ((middle.load(std::memory_order_relaxed) & FRESH) == 0) return nullptr;
+    unsigned char previous = middle.exchange(front, std::memory_order_acq_rel);
+    front = previous & INDEX;
+    return &slots[front];
+  }
+
+ private:
+  static constexpr unsigned char INDEX = 0x3;
+  static constexpr unsigned char FRESH = 0x4;
+
+  T slots[3];
+  unsigned char back = 0;
+  unsigned char front = 1;
+  std::atomic<unsigned char> middle{2};
+};
+
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ Live mode. A dedicated thread with its own X connection subscribes to XDamage on the root window and, whenever   │
+ * │ something changed, re-captures just the damaged rectangles (converting them for the CPU swizzle path if needed)  │
+ * │ and publishes them as one frame through a TripleBuffer. The render loop picks the latest frame up without ever   │
+ * │ blocking in an X call and pushes each rectangle into the desktop texture with UpdateTextureRec, so the CPU and   │
+ * │ bus cost follows what actually changed on screen instead of the size of the desktop.                             │
+ * │ Damage under our own window is ignored: re-capturing it would only capture urblind itself, feeding every frame   │
+ * │ back into the next one. Live mode is meant for watching another monitor.                                         │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+class LiveCapture {
+ public:
+  // Stats for the debug panel, updated by Update on the render thread
+  int updatedRects = 0;
+  long updatedPixels = 0;
+  double frameAgeMs = 0.0;
+  std::atomic<unsigned> droppedFrames{0};
+
+  ~LiveCapture() { Stop(); }
+
+  // Subscribes to damage right away (so nothing that changes from now on is missed), then captures on its own thread
+  bool Start(int desktopWidth, int desktopHeight, Rectangle ignoredArea, bool convertToRGBA) {
+    Stop();
+    display = XOpenDisplay(nullptr);
+    if (!display) {
+      std::cerr << "Live mode: cannot open X11 display!" << std::endl;
+      return false;
+    }
+
+    int errorBase = 0;
+    if (!XDamageQueryExtension(display, &damageEventBase, &errorBase)) {
+      std::cerr << "Live mode: the X server has no DAMAGE extension, falling back to a frozen screenshot." << std::endl;
+      XCloseDisplay(display);
+      display = nullptr;
+      return false;
+    }
+
+    root = DefaultRootWindow(display);
+    desktop = {0, 0, static_cast<float>(desktopWidth), static_cast<float>(desktopHeight)};
+    ignored = ignoredArea;
+    convert = convertToRGBA;
+    damage = XDamageCreate(display, root, XDamageReportNonEmpty);
+    region = XFixesCreateRegion(display, nullptr, 0);
+    useShm = XShmQueryExtension(display);
+    XSync(display, False);
+
+    updatedRects = 0;
+    updatedPixels = 0;
+    frameAgeMs = 0.0;
+    droppedFrames = 0;
+    if (pipe(wakePipe) != 0) wakePipe[0] = wakePipe[1] = -1;
+    stopping = false;
+    thread = std::thread([this]() { CaptureLoop(); });
+    return true;
+  }
+
+  bool Active() const { return display != nullptr; }
+
+  // Uploads the latest frame the capture thread published, if any. Never waits for it.
+  bool Update(DesktopTexture& texture) {
+    LiveFrame* frame = frames.Take();
+    if (!frame) return false;
+
+    updatedRects = frame->count;
+    updatedPixels = 0;
+    for (int i = 0; i < frame->count; i++) {
+      const CapturePatch& patch = frame->patches[i];
+      texture.UploadPixels(patch.rec, patch.pixels.data());
+      updatedPixels += static_cast<long>(patch.rec.width) * static_cast<long>(patch.rec.height);
+    }
+    std::chrono::duration<double, std::milli> age = std::chrono::steady_clock::now() - frame->capturedAt;
+    frameAgeMs = age.count();
+    return true;
+  }
+
+  void Stop() {
+    if (!display) return;
+    stopping = true;
+    if (wakePipe[1] >= 0) (void)!write(wakePipe[1], "x", 1);
+    if (thread.joinable()) thread.join();
+    for (int fd : wakePipe) {
+      if (fd >= 0) close(fd);
+    }
+    wakePipe[0] = wakePipe[1] = -1;
+
+    ReleaseSegment();
+    XFixesDestroyRegion(display, region);
+    XDamageDestroy(display, damage);
+    XCloseDisplay(display);
+    display = nullptr;
+  }
+
+ private:
+  static constexpr int MAX_RECTS = 64;
+
+  struct LiveFrame {
+    std::vector<CapturePatch> patches;  // only the first count are part of the frame; the rest keep their buffers
+    int count = 0;
+    std::chrono::steady_clock::time_point capturedAt;
+  };
+
+  TripleBuffer<LiveFrame> frames;
+  std::thread thread;
+  std::atomic<bool> stopping{false};
+  int wakePipe[2] = {-1, -1};
+
+  // Everything below belongs to the capture thread once it's running
+  Display* display = nullptr;
+  Window root = 0;
+  Damage damage = 0;
+  XserverRegion region = 0;
+  int damageEventBase = 0;
+  Rectangle desktop = {0};
+  Rectangle ignored = {0};
+  bool convert = false;
+  bool useShm = false;
+  XShmSegmentInfo shmInfo = {};
+  size_t shmCapacity = 0;
+
+  void CaptureLoop() {
+    std::vector<Rectangle> pending;
+    pollfd fds[2] = {{ConnectionNumber(display), POLLIN, 0}, {wakePipe[0], POLLIN, 0}};
+
+    while (!stopping) {
+      // Sleep until X has something for us; when only leftovers from a dropped frame are pending, check back soon
+      if (XPending(display) == 0) poll(fds, wakePipe[0] >= 0 ? 2 : 1, pending.empty() ? -1 : 16);
+      if (stopping) break;
+
+      bool damaged = false;
+      while (XPending(display) > 0) {
+        XEvent event;
+        XNextEvent(display, &event);
+        if (event.type == damageEventBase + XDamageNotify) damaged = true;
+      }
+      if (damaged) CollectDamage(pending);
+      if (pending.empty()) continue;
+
+      LiveFrame& frame = frames.Back();
+      frame.count = 0;
+      for (const Rectangle& rec : pending) {
+        if (frame.count == static_cast<int>(frame.patches.size())) frame.patches.emplace_back();
+        if (CaptureRect(rec, frame.patches[frame.count])) frame.count++;
+      }
+      pending.clear();
+      frame.capturedAt = std::chrono::steady_clock::now();
+
+      // The render loop never saw the frame we just replaced, so its rectangles go into the next one, freshly captured
+      if (frames.Publish()) {
+        droppedFrames++;
+        const LiveFrame& dropped = frames.Back();
+        for (int i = 0; i < dropped.count; i++) pending.push_back(dropped.patches[i].rec);
+      }
+      glfwPostEmptyEvent();
+    }
+  }
+
+  // Takes the damage accumulated so far (clearing it in one go, so changes made while we capture show up next time)
+  void CollectDamage(std::vector<Rectangle>& pending) {
+    XDamageSubtract(display, damage, None, region);
+    int count = 0;
+    XRectangle bounds;
+    XRectangle* rects = XFixesFetchRegionAndBounds(display, region, &count, &bounds);
+
+    auto add = [&](const XRectangle& rect) {
+      Rectangle rec = GetCollisionRec({static_cast<float>(rect.x), static_cast<float>(rect.y),
+                                       static_cast<float>(rect.width), static_cast<float>(rect.height)},
+                                      desktop);
+      for (const Rectangle& part : SubtractRectangle(rec, ignored)) pending.push_back(part);
+    };
+    // Lots of tiny rectangles cost more in round trips than re-capturing their bounding box once
+    if (count > MAX_RECTS) {
+      add(bounds);
+    } else {
+      for (int i = 0; i < count; i++) add(rects[i]);
+    }
+    if (rects) XFree(rects);
+  }
+
+  bool CaptureRect(Rectangle rec, CapturePatch& patch) {
+    const int x = static_cast<int>(rec.x);
+    const int y = static_cast<int>(rec.y);
+    const int width = static_cast<int>(rec.width);
+    const int height = static_cast<int>(rec.height);
+
+    if (useShm && EnsureSegment(static_cast<size_t>(width) * height * 4)) {
+      int screen = DefaultScreen(display);
+      XImage* img = XShmCreateImage(display, DefaultVisual(display, screen), DefaultDepth(display, screen), ZPixmap,
+                                    shmInfo.shmaddr, &shmInfo, width, height);
+      if (img) {
+        bool grabbed = XShmGetImage(display, root, img, x, y, AllPlanes);
+        if (grabbed) CopyToPatch(img, rec, patch);
+        img->data = nullptr;  // the segment outlives this image header
+        XDestroyImage(img);
+        if (grabbed) return true;
+      }
+    }
+
+    XImage* img = XGetImage(display, root, x, y, width, height, AllPlanes, ZPixmap);
+    if (!img) return false;
+    CopyToPatch(img, rec, patch);
+    XDestroyImage(img);
+    return true;
+  }
+
+  // Tightly packed, in the texture's channel order; the patch buffer is reused from frame to frame
+  void CopyToPatch(const XImage* img, Rectangle rec, CapturePatch& patch) const {
+    const size_t rowBytes = static_cast<size_t>(img->width) * 4;
+    patch.rec = rec;
+    patch.pixels.resize(rowBytes * img->height);
+    if (convert) {
+      ConvertBGRXToRGBAParallel(img, patch.pixels.data());
+      return;
+    }
+    for (int row = 0; row < img->height; row++) {
+      std::memcpy(patch.pixels.data() + row * rowBytes, img->data + row * img->bytes_per_line, rowBytes);
+    }
+  }
+
+  // Makes sure the shared segment can hold at least the given number of bytes, growing it if needed
+  bool EnsureSegment(size_t bytes) {
+    if (bytes <= shmCapacity) return true;
+    ReleaseSegment();
+
+    shmInfo.shmid = shmget(IPC_PRIVATE, bytes, IPC_CREAT | 0600);
+    if (shmInfo.shmid < 0) {
+      useShm = false;
+      return false;
+    }
+    shmInfo.shmaddr = static_cast<char*>(shmat(shmInfo.shmid, nullptr, 0));
+    shmctl(shmInfo.shmid, IPC_RMID, nullptr);
+    if (shmInfo.shmaddr == reinterpret_cast<char*>(-1)) {
+      useShm = false;
+      return false;
+    }
+    shmInfo.readOnly = False;
+
+    bool attachFailed = false;
+    {
+      std::lock_guard<std::mutex> lock(xShmAttachMutex);
+      xShmAttachFailed = false;
+      XErrorHandler previousHandler = XSetErrorHandler(HandleShmAttachError);
+      XShmAttach(display, &shmInfo);
+      XSync(display, False);
+      XSetErrorHandler(previousHandler);
+      attachFailed = xShmAttachFailed;
+    }
+    if (attachFailed) {
+      shmdt(shmInfo.shmaddr);
+      useShm = false;
+      return false;
+    }
+
+    shmCapacity = bytes;
+    return true;
+  }
+
+  void ReleaseSegment() {
+    if (shmCapacity == 0) return;
+    XShmDetach(display, &shmInfo);
+    shmdt(shmInfo.shmaddr);
+    shmInfo = {};
+    shmCapacity = 0;
+  }
+};
+
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ This function helps us to control the "virtual camera" in regards to the pan, zoom, and the texture size limits. │
+ * │ It prevents the camera from going beyond the texture limits when zoomed in (when the viewport is smaller than    │
+ * │ the texture) and centers the texture when zoomed out (when the viewport is larger than the texture).             │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+void ClampPan(Vector2& pan, float zoom, Vector2 textureSize, Vector2 screenSize) {
+  float visibleWidth = screenSize.x / zoom;
+  float visibleHeight = screenSize.y / zoom;
+
+  // center the zoomed out texture if smaller than the viewport
+  if (visibleWidth >= textureSize.x) {
+    pan.x = (textureSize.x - visibleWidth) / 2.0f;
+  } else {
+    pan.x = std::max(0.0f, std::min(pan.x, textureSize.x - visibleWidth));
+  }
+
+  if (visibleHeight >= textureSize.y) {
+    pan.y = (textureSize.y - visibleHeight) / 2.0f;
+  } else {
+    pan.y = std::max(0.0f, std::min(pan.y, textureSize.y - visibleHeight));
+  }
+}
+
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ This is a helper function that returns the mouse position coordinates in texture space. It considers our current │
+ * │ pan and zoom to return exactly the X and Y coordinates of the texture pixel we have the mouse cursor on.         │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+Vector2 GetMousePositionOnTexture(Vector2 mouseViewport, Vector2 pan, float zoom) {
+  return {(mouseViewport.x / zoom) + pan.x, (mouseViewport.y / zoom) + pan.y};
+}
+
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ This is a helper function that helps zooming with an aim. It takes our mouse position coordinates in texture     │
+ * │ space, our previous zoom level (before triggering the mouse wheel event to zoom), our next zoom level (after     │
+ * │ triggering the mouse wheel event), and our current pan coordinates. Then it computes the pan coordinates         │
+ * │ so the texture pixel under our mouse cursor ends up being the same after zooming. Maybe there's a better way to  │
+ * │ achieve the same, but that kinda works.                                                                          │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+Vector2 ComputeTargetPan(Vector2 mouseOnTexture, float previousZoom, float nextZoom, Vector2 currentPan) {
+  Vector2 targetPan;
+  targetPan.x = mouseOnTexture.x - ((mouseOnTexture.x - currentPan.x) * (previousZoom / nextZoom));
+  targetPan.y = mouseOnTexture.y - ((mouseOnTexture.y - currentPan.y) * (previousZoom / nextZoom));
+  return targetPan;
+}
+
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ Builds the debug panel Font out of the atlas and glyph metrics baked at build time (see tools/bakefont.cpp), so  │
+ * │ there is no TTF to parse nor glyphs to rasterize at runtime. The atlas only stores alpha; raylib wants white     │
+ * │ gray+alpha texels, so we expand it here. Everything is allocated with raylib's allocator because UnloadFont is   │
+ * │ who frees it.                                                                                                    │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+Font LoadDebugFont() {
+  const int texelCount = debugfont_atlas_width * debugfont_atlas_height;
+  unsigned char* grayAlpha = static_cast<unsigned char*>(MemAlloc(texelCount * 2));
+  for (int i = 0; i < texelCount; i++) {
+    grayAlpha[i * 2 + 0] = 255;
+    grayAlpha[i * 2 + 1] = debugfont_atlas_alpha[i];
+  }
+  Image atlas = {.data = grayAlpha,
+                 .width = debugfont_atlas_width,
+                 .height = debugfont_atlas_height,
+                 .mipmaps = 1,
+                 .format = PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA};
+
+  Font font = {0};
+  font.baseSize = debugfont_base_size;
+  font.glyphCount = debugfont_glyph_count;
+  font.glyphPadding = debugfont_glyph_padding;
+  font.texture = LoadTextureFromImage(atlas);
+  UnloadImage(atlas);
+
+  font.recs = static_cast<Rectangle*>(MemAlloc(font.glyphCount * sizeof(Rectangle)));
+  font.glyphs = static_cast<GlyphInfo*>(MemAlloc(font.glyphCount * sizeof(GlyphInfo)));
+  for (int i = 0; i < font.glyphCount; i++) {
+    const DebugFontGlyph& glyph = debugfont_glyphs[i];
+    font.recs[i] = {glyph.x, glyph.y, glyph.width, glyph.height};
+    font.glyphs[i] = {.value = glyph.codepoint,
+                      .offsetX = glyph.offsetX,
+                      .offsetY = glyph.offsetY,
+                      .advanceX = glyph.advanceX,
+                      .image = {0}};
+  }
+
+  return font;
+}
+
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ Instanced glyph renderer on top of a Font's atlas. DrawTextEx submits every glyph as its own quad through the    │
+ * │ immediate-mode batch; here each glyph is just one 36-byte instance (screen rect, atlas rect, color) appended to  │
+ * │ a CPU array, and Draw uploads the lot into a single instance buffer and renders every glyph with one instanced   │
+ * │ draw call over a shared unit quad. That's what makes dense overlays (per-pixel values and the like) affordable.  │
+ * │ Needs GL 3.3; anything older gets the same glyphs through DrawTexturePro instead. A font that failed to load is  │
+ * │ replaced with raylib's default one, and until Load succeeds glyphs are drawn right away with the default font    │
+ * │ instead of being queued, so a missing atlas costs the batching but never dereferences a null glyph table.        │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+class GlyphBatcher {
+ public:
+  struct Instance {
+    float x, y, width, height;  // on screen
+    float u0, v0, u1, v1;       // in the atlas, normalized
+    unsigned char r, g, b, a;
+  };
+
+  bool Load(const Font& atlasFont) {
+    Unload();
+    font = atlasFont.texture.id != 0 && atlasFont.recs && atlasFont.glyphs ? atlasFont : GetFontDefault();
+    loaded = font.texture.id != 0 && font.recs && font.glyphs;
+    if (!loaded) return false;
+
+    int version = rlGetVersion();
+    if (version != RL_OPENGL_33 && version != RL_OPENGL_43) {
+      std::cout << "Glyph batcher: no GL 3.3, falling back to DrawTexturePro" << std::endl;
+      return true;
+    }
+
+    shader = LoadShaderFromMemory(VERTEX_SHADER, FRAGMENT_SHADER);
+    if (shader.id == rlGetShaderIdDefault()) {
+      shader = {0};
+      return true;
+    }
+    mvpLocation = GetShaderLocation(shader, "mvp");
+    atlasLocation = GetShaderLocation(shader, "atlas");
+    instanced = Reserve(4096);
+    return true;
+  }
+
+  void Unload() {
+    ReleaseBuffers();
+    if (shader.id != 0) UnloadShader(shader);
+    shader = {0};
+    instanced = false;
+    loaded = false;
+    instances.clear();
+  }
+
+  // The font glyphs are laid out with, for measuring text the same way
+  Font Atlas() const { return loaded ? font : GetFontDefault(); }
+
+  // Queues a single glyph with its top-left (like DrawTextCodepoint) at position
+  void AddCodepoint(int codepoint, Vector2 position, float fontSize, Color color) {
+    if (!loaded) {
+      DrawTextCodepoint(GetFontDefault(), codepoint, position, fontSize, color);
+      return;
+    }
+    int index = GetGlyphIndex(font, codepoint);
+    const Rectangle& rec = font.recs[index];
+    const GlyphInfo& glyph = font.glyphs[index];
+    float scale = fontSize / font.baseSize;
+    float padding = font.glyphPadding;
+
+    float atlasWidth = font.texture.width;
+    float atlasHeight = font.texture.height;
+    instances.push_back({position.x + (glyph.offsetX - padding) * scale, position.y + (glyph.offsetY - padding) * scale,
+                         (rec.width + 2.0f * padding) * scale, (rec.height + 2.0f * padding) * scale,
+                         (rec.x - padding) / atlasWidth, (rec.y - padding) / atlasHeight,
+                         (rec.x + rec.width + padding) / atlasWidth, (rec.y + rec.height + padding) / atlasHeight,
+                         color.r, color.g, color.b, color.a});
+  }
+
+  // Queues a UTF-8 string the way DrawTextEx lays it out. Returns the pen position after the last glyph.
+  Vector2 AddText(const char* text, Vector2 position, float fontSize, float spacing, Color color) {
+    const Font atlas = Atlas();
+    if (atlas.glyphs == nullptr) return position;  // no window yet, so no default font either
+    float scale = fontSize / atlas.baseSize;
+    Vector2 pen = position;
+    for (int i = 0; text[i] != '\0';) {
+      int bytes = 0;
+      int codepoint = GetCodepointNext(&text[i], &bytes);
+      i += bytes;
+      if (codepoint == '\n') {
+        pen = {position.x, pen.y + fontSize + 2.0f};  // raylib's default text line spacing
+        continue;
+      }
+
+      int index = GetGlyphIndex(atlas, codepoint);
+      if (codepoint != ' ' && codepoint != '\t') AddCodepoint(codepoint, pen, fontSize, color);
+      float advance = atlas.glyphs[index].advanceX != 0 ? atlas.glyphs[index].advanceX : atlas.recs[index].width;
+      pen.x += advance * scale + spacing;
+    }
+    return pen;
+  }
+
+  size_t Count() const { return instances.size(); }
+
+  // Renders everything queued since the last Draw, in one draw call, on top of whatever raylib has drawn so far
+  void Draw() {
+    if (instances.empty()) return;
+    if (!instanced || !Reserve(instances.size())) {
+      DrawFallback();
+      instances.clear();
+      return;
+    }
+
+    rlDrawRenderBatchActive();  // keep ordering with everything raylib batched before us
+
+    rlEnableShader(shader.id);
+    rlSetUniformMatrix(mvpLocation, MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection()));
+    int slot = 0;
+    rlSetUniform(atlasLocation, &slot, SHADER_UNIFORM_INT, 1);
+    rlActiveTextureSlot(0);
+    rlEnableTexture(font.texture.id);
+
+    rlEnableVertexArray(vao);
+    rlUpdateVertexBuffer(instanceBuffer, instances.data(), instances.size() * sizeof(Instance), 0);
+    rlDrawVertexArrayInstanced(0, 6, instances.size());
+    rlDisableVertexArray();
+
+    rlDisableTexture();
+    rlDisableShader();
+    instances.clear();
+  }
+
+ private:
+  static constexpr const char* VERTEX_SHADER = R"(#version 330
+layout(location = 0) in vec2 corner;
+layout(location = 1) in vec4 instanceRect;
+layout(location = 2) in vec4 instanceUV;
+layout(location = 3) in vec4 instanceColor;
+uniform mat4 mvp;
+out vec2 fragUV;
+out vec4 fragColor;
+void main() {
+  fragUV = mix(instanceUV.xy, instanceUV.zw, corner);
+  fragColor = instanceColor;
+  gl_Position = mvp * vec4(instanceRect.xy + corner * instanceRect.zw, 0.0, 1.0);
+}
+)";
+
+  static constexpr const char* FRAGMENT_SHADER = R"(#version 330
+in vec2 fragUV;
+in vec4 fragColor;
+uniform sampler2D atlas;
+out vec4 finalColor;
+void main() {
+  finalColor = vec4(fragColor.rgb, fragColor.a * texture(atlas, fragUV).a);
+}
+)";
+
+  Font font = {0};
+  Shader shader = {0};
+  int mvpLocation = -1;
+  int atlasLocation = -1;
+  bool instanced = false;
+  bool loaded = false;  // font has an atlas and glyph tables
+
+  unsigned int vao = 0;
+  unsigned int quadBuffer = 0;
+  unsigned int instanceBuffer = 0;
+  size_t capacity = 0;
+  std::vector<Instance> instances;
+
+  // Makes sure the instance buffer holds at least count instances, growing it (and the VAO around it) if needed
+  bool Reserve(size_t count) {
+    if (count <= capacity) return true;
+    ReleaseBuffers();
+    size_t newCapacity = std::max<size_t>(count, capacity * 2);
+
+    // Two triangles over the unit square; each vertex is just which corner of the glyph rect it is
+    static const float corners[] = {0, 0, 0, 1, 1, 1, 0, 0, 1, 1, 1, 0};
+
+    vao = rlLoadVertexArray();
+    if (vao == 0) return false;
+    rlEnableVertexArray(vao);
+
+    quadBuffer = rlLoadVertexBuffer(corners, sizeof(corners), false);
+    rlSetVertexAttribute(0, 2, RL_FLOAT, false, 0, 0);
+    rlEnableVertexAttribute(0);
+
+    instanceBuffer = rlLoadVertexBuffer(nullptr, newCapacity * sizeof(Instance), true);
+    const int stride = sizeof(Instance);
+    rlSetVertexAttribute(1, 4, RL_FLOAT, false, stride, offsetof(Instance, x));
+    rlSetVertexAttribute(2, 4, RL_FLOAT, false, stride, offsetof(Instance, u0));
+    rlSetVertexAttribute(3, 4, RL_UNSIGNED_BYTE, true, stride, offsetof(Instance, r));
+    for (unsigned int attribute = 1; attribute <= 3; attribute++) {
+      rlEnableVertexAttribute(attribute);
+      rlSetVertexAttributeDivisor(attribute, 1);
+    }
+    rlDisableVertexArray();
+
+    capacity = newCapacity;
+    instances.reserve(capacity);
+    return true;
+  }
+
+  void ReleaseBuffers() {
+    if (vao != 0) rlUnloadVertexArray(vao);
+    if (quadBuffer != 0) rlUnloadVertexBuffer(quadBuffer);
+    if (instanceBuffer != 0) rlUnloadVertexBuffer(instanceBuffer);
+    vao = quadBuffer = instanceBuffer = 0;
+    capacity = 0;
+  }
+
+  void DrawFallback() const {
+    float atlasWidth = font.texture.width;
+    float atlasHeight = font.texture.height;
+    for (const Instance& glyph : instances) {
+      Rectangle source = {glyph.u0 * atlasWidth, glyph.v0 * atlasHeight, (glyph.u1 - glyph.u0) * atlasWidth,
+                          (glyph.v1 - glyph.v0) * atlasHeight};
+      DrawTexturePro(font.texture, source, {glyph.x, glyph.y, glyph.width, glyph.height}, {0, 0}, 0,
+                     {glyph.r, glyph.g, glyph.b, glyph.a});
+    }
+  }
+};
+
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ A debug panel line. valueFunc returns a C string (typically TextFormat's static buffer), which is copied into    │
+ * │ the entry's own "label: value" buffer right away. The buffer keeps its capacity from frame to frame and the      │
+ * │ width is only measured again when the text actually changed, so a steady panel doesn't allocate at all.          │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+struct DebugInfo {
+  std::string label;
+  std::function<const char*()> valueFunc;
+  std::string text;  // "label: value"
+  int width = 0;     // of text, in the panel's font
+};
+
+enum class DebugAnchor { TOP_LEFT, TOP_RIGHT, BOTTOM_LEFT, BOTTOM_RIGHT };
+
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ This is just a small class I'll use as a debug panel to show some values in real-time because I didn't want to   │
+ * │ bloat such a minimal and simple app with any overkill stuff like Dear ImGui or any other sophisticated GUI       │
+ * │ library. I don't want the debug info to be ugly tho, so I'm writing this.                                        │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+
+class DebugPanel {
+ public:
+  int x, y;
+  int fontSize;
+  float padding;
+  bool visible = false;
+  std::vector<DebugInfo> entries;
+  int longestEntryEver = 0;
+  Font myFont = {0};
+  GlyphBatcher glyphs;
+  bool fontLoaded = false;
+  double fontLoadMs = 0.0;
+  DebugAnchor anchor = DebugAnchor::TOP_LEFT;  // Default
+  std::function<void(Rectangle)> footer;       // optional graph drawn under the entries
+  int footerHeight = 0;
+  Rectangle bounds = {0, 0, 0, 0};  // where the panel was last drawn, for overlays that sit next to it
+
+  // The font (our only GPU resource) is only loaded the first time the panel is shown, so launches without --debug
+  // don't pay for it at all.
+  DebugPanel(int startX, int startY, int textSize = 20, float spacingMultiplier = 1.0f)
+      : x(startX), y(startY), fontSize(textSize), padding(textSize * spacingMultiplier) {}
+
+  void SetAnchor(DebugAnchor newAnchor) { anchor = newAnchor; }
+
+  void Dispose() {
+    if (fontLoaded) {
+      glyphs.Unload();
+      UnloadFont(myFont);
+    }
+    fontLoaded = false;
+  }
+
+  void AddEntry(const std::string& label, std::function<const char*()> valueFunc) {
+    std::string text = label + ": ";
+    text.reserve(text.size() + 64);
+    entries.push_back({label, valueFunc, text, -1});
+  }
+
+  void SetFooter(int height, std::function<void(Rectangle)> drawFunc) {
+    footerHeight = height;
+    footer = drawFunc;
+  }
+
+  void SetVisible(bool isVisible) {
+    visible = isVisible;
+    if (visible && !fontLoaded) LoadResources();
+  }
+
+  void LoadResources() {
+    StartupProfiler::Scope phase(Profiler(), "DebugPanel font load");
+    auto start = std::chrono::steady_clock::now();
+    myFont = LoadDebugFont();
+    fontLoadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    fontLoaded = true;
+
+    if (myFont.texture.id == 0) {
+      std::cerr << "Failed to load the baked debug font, using the default one" << std::endl;
+    } else {
+      std::cout << "Baked debug font loaded in " << TextFormat("%.2f", fontLoadMs) << " ms" << std::endl;
+    }
+    glyphs.Load(myFont);
+  }
+
+  void Draw() {
+    if (!visible) return;
+
+    int entriesSize = entries.size();
+    for (auto& entry : entries) {
+      const char* value = entry.valueFunc();
+      const size_t prefixLength = entry.label.size() + 2;
+      if (entry.width < 0 || entry.text.compare(prefixLength, std::string::npos, value) != 0) {
+        entry.text.resize(prefixLength);
+        entry.text.append(value);
+        entry.width = MeasureTextEx(glyphs.Atlas(), entry.text.c_str(), fontSize, 0).x;
+      }
+      longestEntryEver = std::max(longestEntryEver, entry.width);
+    }
+
+    float pad = fontSize * 0.5f;
+    int panelWidth = longestEntryEver + fontSize;
+    int panelHeight = padding * entries.size() + fontSize + footerHeight;
+
+    // Compute screen bounds
+    int screenWidth = GetScreenWidth();
+    int screenHeight = GetScreenHeight();
+
+    // Determine the actual X and Y based on the anchor
+    int adjustedX = x;
+    int adjustedY = y;
+
+    switch (anchor) {
+      case DebugAnchor::TOP_LEFT:
+        break;  // Keep default X and Y
+      case DebugAnchor::TOP_RIGHT:
+        adjustedX = screenWidth - panelWidth - x + fontSize;
+        break;
+      case DebugAnchor::BOTTOM_LEFT:
+        adjustedY = screenHeight - panelHeight - y + fontSize;
+        break;
+      case DebugAnchor::BOTTOM_RIGHT:
+        adjustedX = screenWidth - panelWidth - x + fontSize;
+        adjustedY = screenHeight - panelHeight - y + fontSize;
+        break;
+    }
+
+    int left = adjustedX - pad;
+    int top = adjustedY - pad;
+    int right = adjustedX + longestEntryEver + pad;
+    int bottom = adjustedY + padding * entriesSize + footerHeight + pad;
+
+    bounds = {static_cast<float>(left), static_cast<float>(top), static_cast<float>(panelWidth),
+              static_cast<float>(panelHeight)};
+    DrawRectangle(left, top, panelWidth, panelHeight, Fade(BLACK, 0.6667f));
+    DrawLine(left, top, right, top, WHITE);        // top
+    DrawLine(left, top, left, bottom, WHITE);      // left
+    DrawLine(right, top, right, bottom, WHITE);    // right
+    DrawLine(left, bottom, right, bottom, WHITE);  // bottom
+
+    float yOffset = adjustedY;
+    for (const auto& entry : entries) {
+      glyphs.AddText(entry.text.c_str(), {static_cast<float>(adjustedX), yOffset}, fontSize, 0, WHITE);
+      yOffset += padding;
+    }
+    glyphs.Draw();
+
+    if (footer) {
+      footer({static_cast<float>(adjustedX), yOffset, static_cast<float>(longestEntryEver),
+              static_cast<float>(footerHeight)});
+    }
+  }
+};
+
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ Sparkline of the most recent frame times, one pixel column per frame, newest on the right. The scale tops out at │
+ * │ two 60 Hz frames with a line at one, so a hitch stands out at a glance: green fits a 60 Hz frame, yellow misses  │
+ * │ one vsync, red misses more (and is clipped to the top).                                                          │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+void DrawFrameTimeGraph(const FrameTimings& timings, Rectangle area) {
+  const float frameBudgetMs = 1000.0f / 60.0f;
+  const float scaleMs = 2.0f * frameBudgetMs;
+  const int bottom = static_cast<int>(area.y + area.height);
+
+  const size_t columns = std::min(timings.Count(), static_cast<size_t>(area.width));
+  for (size_t i = 0; i < columns; i++) {
+    float ms = timings.At(timings.Count() - columns + i).totalMs;
+    int barHeight = std::max(1, static_cast<int>(std::min(ms / scaleMs, 1.0f) * area.height));
+    Color color = ms <= frameBudgetMs ? GREEN : ms <= scaleMs ? YELLOW : RED;
+    int column = static_cast<int>(area.x + area.width) - static_cast<int>(columns) + static_cast<int>(i);
+    DrawLine(column, bottom, column, bottom - barHeight, color);
+  }
+
+  int budgetLine = bottom - static_cast<int>(area.height * frameBudgetMs / scaleMs);
+  DrawLine(area.x, budgetLine, area.x + area.width, budgetLine, Fade(WHITE, 0.5f));
+}
+
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ CPU snapshot of the desktop for the overlays that read pixel values. It is refreshed when the texture changed,   │
+ * │ but at most every REFRESH_INTERVAL seconds. Changes made by live mode don't count (see SkipChanges): following   │
+ * │ them would mean a full GPU readback, plus an integral image and histogram rebuild, on the render thread every    │
+ * │ REFRESH_INTERVAL for as long as anything on screen moves, so the snapshot is paused until live mode stops. The   │
+ * │ render loop shouldn't go idle while Pending, or the last change would only show up on the next input event.      │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+class DesktopPixelCache {
+ public:
+  static constexpr double REFRESH_INTERVAL = 0.25;
+
+  const DesktopPixels* Get(DesktopTexture& desktop) {
+    double now = GetTime();
+    if (!pixels || (desktop.Generation() != generation && now - refreshedAt >= REFRESH_INTERVAL)) {
+      pixels = desktop.Pixels();
+      generation = desktop.Generation();
+      refreshedAt = now;
+      version++;
+    }
+    return pixels.get();
+  }
+
+  bool Pending(const DesktopTexture& desktop) const { return pixels && desktop.Generation() != generation; }
+
+  // Marks the texture changes between generations before and after (a live update) as already seen, as long as the
+  // snapshot was up to date before them, so a streamed region that is still pending gets picked up all the same
+  void SkipChanges(unsigned before, unsigned after) {
+    if (pixels && generation == before) generation = after;
+  }
+
+  bool Held() const { return pixels != nullptr; }
+
+  // Seconds since the snapshot was taken
+  double Age() const { return GetTime() - refreshedAt; }
+
+  // Bumped every time the snapshot is replaced, so derived data (a summed-area table) knows when to rebuild
+  unsigned Version() const { return version; }
+
+  // Lets go of the snapshot (up to a full desktop of RGBA) once no overlay needs it
+  void Release() { pixels.reset(); }
+
+ private:
+  std::shared_ptr<const DesktopPixels> pixels;
+  unsigned generation = 0;
+  unsigned version = 0;
+  double refreshedAt = 0.0;
+};
+
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ Pixel grid overlay (G). Once zoomed in far enough for desktop pixels to be distinct squares, a single full-      │
+ * │ screen shader pass draws the lines between them (the fragment shader maps each screen pixel back to desktop      │
+ * │ coordinates and lights up the ones within a pixel of a cell edge), and once a cell is wide enough to hold it,    │
+ * │ every visible pixel gets its #RRGGBB value printed inside, all queued into one GlyphBatcher draw call.           │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+class PixelGridOverlay {
+ public:
+  static constexpr float GRID_MIN_ZOOM = 8.0f;
+  static constexpr float LABEL_MARGIN = 6.0f;
+
+  bool enabled = false;
+  int labelCount = 0;  // drawn last frame, for the debug panel
+
+  void Toggle() {
+    enabled = !enabled;
+    if (enabled && !loaded) Load();
+  }
+
+  // Labels need CPU pixels, so the caller only fetches them when this says so
+  bool WantsLabels(float zoom) const { return enabled && loaded && zoom >= labelWidth + LABEL_MARGIN; }
+
+  void Draw(Vector2 pan, float zoom, int screenWidth, int screenHeight, const DesktopPixels* pixels) {
+    labelCount = 0;
+    if (!enabled || !loaded || zoom < GRID_MIN_ZOOM) return;
+
+    if (shader.id != 0) {
+      float origin[2] = {pan.x, pan.y};
+      float height = static_cast<float>(screenHeight);
+      SetShaderValue(shader, originLocation, origin, SHADER_UNIFORM_VEC2);
+      SetShaderValue(shader, zoomLocation, &zoom, SHADER_UNIFORM_FLOAT);
+      SetShaderValue(shader, screenHeightLocation, &height, SHADER_UNIFORM_FLOAT);
+      BeginShaderMode(shader);
+      DrawRectangle(0, 0, screenWidth, screenHeight, Fade(BLACK, 0.5f));
+      EndShaderMode();
+    }
+
+    if (!pixels || !WantsLabels(zoom)) return;
+
+    // Only the cells on screen (and on the desktop; the mirrored repeat around it gets no labels)
+    const int firstX = std::max(0, static_cast<int>(std::floor(pan.x)));
+    const int firstY = std::max(0, static_cast<int>(std::floor(pan.y)));
+    const int lastX = std::min(pixels->width - 1, static_cast<int>(std::floor(pan.x + screenWidth / zoom)));
+    const int lastY = std::min(pixels->height - 1, static_cast<int>(std::floor(pan.y + screenHeight / zoom)));
+    const float fontSize = glyphs.Atlas().baseSize;
+
+    char label[8];
+    for (int y = firstY; y <= lastY; y++) {
+      for (int x = firstX; x <= lastX; x++) {
+        const unsigned char* rgba = pixels->rgba.data() + (static_cast<size_t>(y) * pixels->width + x) * 4;
+        std::snprintf(label, sizeof(label), "#%02X%02X%02X", rgba[0], rgba[1], rgba[2]);
+
+        // Dark text on light pixels and the other way around (Rec. 601 luma)
+        const int luma = (299 * rgba[0] + 587 * rgba[1] + 114 * rgba[2]) / 1000;
+        Vector2 position = {(x - pan.x) * zoom + (zoom - labelWidth) / 2.0f,
+                            (y - pan.y) * zoom + (zoom - fontSize) / 2.0f};
+        glyphs.AddText(label, position, fontSize, 0, luma > 127 ? BLACK : WHITE);
+        labelCount++;
+      }
+    }
+    glyphs.Draw();
+  }
+
+  void Unload() {
+    if (!loaded) return;
+    glyphs.Unload();
+    UnloadFont(font);
+    if (shader.id != 0) UnloadShader(shader);
+    shader = {0};
+    loaded = false;
+  }
+
+ private:
+  static constexpr const char* GRID_SHADER = R"(#version 330
+in vec2 fragTexCoord;
+in vec4 fragColor;
+uniform vec2 origin;
+uniform float zoom;
+uniform float screenHeight;
+out vec4 finalColor;
+void main() {
+  vec2 screen = vec2(gl_FragCoord.x, screenHeight - gl_FragCoord.y);
+  vec2 cell = fract(origin + screen / zoom) * zoom;
+  finalColor = min(cell.x, cell.y) < 1.0 ? fragColor : vec4(0.0);
+}
+)";
+
+  bool loaded = false;
+  Font font = {0};
+  GlyphBatcher glyphs;
+  Shader shader = {0};
+  int originLocation = -1;
+  int zoomLocation = -1;
+  int screenHeightLocation = -1;
+  float labelWidth = 0.0f;
+
+  void Load() {
+    font = LoadDebugFont();
+    glyphs.Load(font);
+    labelWidth = MeasureTextEx(glyphs.Atlas(), "#DDDDDD", glyphs.Atlas().baseSize, 0).x;
+
+    int version = rlGetVersion();
+    if (version == RL_OPENGL_33 || version == RL_OPENGL_43) {
+      shader = LoadShaderFromMemory(nullptr, GRID_SHADER);
+      if (shader.id == rlGetShaderIdDefault()) shader = {0};
+    }
+    if (shader.id != 0) {
+      originLocation = GetShaderLocation(shader, "origin");
+      zoomLocation = GetShaderLocation(shader, "zoom");
+      screenHeightLocation = GetShaderLocation(shader, "screenHeight");
+    } else {
+      std::cerr << "Pixel grid shader unavailable, showing the color labels only" << std::endl;
+    }
+    loaded = true;
+  }
+};
+
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ Integral images of the CPU snapshot, so the color picker and the region statistics answer any rectangle without  │
+ * │ touching its pixels. Per pixel there's a summed-area table of R, G and B (21-bit lanes of one uint64) and one of │
+ * │ their squares (uint32 each). Both are allowed to wrap: inclusion-exclusion still gives the exact sum of any      │
+ * │ rectangle that can't overflow a lane, which holds for anything inside a BLOCK×BLOCK block (4096 × 255 < 2^21 and │
+ * │ 4096 × 255² < 2^32). Bigger rectangles take their aligned interior from an exact uint64 table over whole blocks, │
+ * │ and only the partial blocks along the border from the per-pixel tables, so a query costs four lookups per        │
+ * │ border block: a handful for a small box, a few hundred for a full-desktop selection, never one per pixel.        │
+ * │ Min and max can't be subtracted like sums, so they come from a min/max pyramid instead (each level halves both   │
+ * │ dimensions); a query peels the odd rows and columns off the rectangle at each level and moves one level up, so   │
+ * │ it reads O(width + height) cells. The picker only needs the sums (8 bytes per desktop pixel); the squares, block │
+ * │ totals and pyramid (another 14 or so) are only built while a selection is up and freed as soon as it's cleared.  │
+ * │ Tables are rebuilt on the worker pool whenever the snapshot changes, and all freed when nothing needs them.      │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+class IntegralImage {
+ public:
+  static constexpr int BLOCK = 64;
+
+  struct Totals {
+    uint64_t count = 0;
+    uint64_t sum[3] = {};
+    uint64_t squares[3] = {};
+  };
+
+  struct Range {
+    unsigned char min[3];
+    unsigned char max[3];
+  };
+
+  bool Ready() const { return source != nullptr; }
+  int Width() const { return width; }
+  int Height() const { return height; }
+
+  // Points at the current snapshot, rebuilding the tables first if it changed (version). withStatistics adds the
+  // tables behind squares, large sums and MinMax, or frees them; without them Sum still works for small rectangles
+  // (it walks every block the rectangle touches) but leaves squares at zero. Must be called every frame before
+  // querying, since the min/max query reads the snapshot itself for the finest level.
+  void Update(const DesktopPixels* pixels, unsigned version, bool withStatistics) {
+    if (!pixels || pixels->width == 0) {
+      source = nullptr;
+      return;
+    }
+    if (!built || version != builtVersion) {
+      BuildSums(*pixels, version);
+      if (withStatistics) BuildStatistics(*pixels);
+    } else if (withStatistics && !statistics) {
+      BuildStatistics(*pixels);
+    }
+    if (!withStatistics && statistics) ReleaseStatistics();
+    source = pixels;
+  }
+
+  // Rectangles are [x0, x1) × [y0, y1) in desktop pixels and are clipped to the desktop
+  Totals Sum(int x0, int y0, int x1, int y1) const {
+    Totals totals;
+    if (!Clip(x0, y0, x1, y1)) return totals;
+
+    const int blockX0 = (x0 + BLOCK - 1) / BLOCK;
+    const int blockY0 = (y0 + BLOCK - 1) / BLOCK;
+    const int blockX1 = x1 / BLOCK;
+    const int blockY1 = y1 / BLOCK;
+    const bool hasInterior = statistics && blockX0 < blockX1 && blockY0 < blockY1;
+    if (hasInterior) AddBlocks(totals, blockX0, blockY0, blockX1, blockY1);
+
+    // Every block the rectangle touches that isn't part of the interior contributes its overlap
+    for (int blockY = y0 / BLOCK; blockY * BLOCK < y1; blockY++) {
+      const bool interiorRow = hasInterior && blockY >= blockY0 && blockY < blockY1;
+      for (int blockX = x0 / BLOCK; blockX * BLOCK < x1; blockX++) {
+        if (interiorRow && blockX == blockX0) {
+          blockX = blockX1;
+          if (blockX * BLOCK >= x1) break;
+        }
+        AddPixels(totals, std::max(x0, blockX * BLOCK), std::max(y0, blockY * BLOCK),
+                  std::min(x1, (blockX + 1) * BLOCK), std::min(y1, (blockY + 1) * BLOCK));
+      }
+    }
+    totals.count = static_cast<uint64_t>(x1 - x0) * (y1 - y0);
+    return totals;
+  }
+
+  Range MinMax(int x0, int y0, int x1, int y1) const {
+    Range range = {{255, 255, 255}, {0, 0, 0}};
+    if (!Clip(x0, y0, x1, y1)) return range;
+
+    auto scan = [&](int level, int cellX0, int cellY0, int cellX1, int cellY1) {
+      for (int y = cellY0; y < cellY1; y++) {
+        for (int x = cellX0; x < cellX1; x++) Merge(range, Cell(level, x, y));
+      }
+    };
+
+    const int topLevel = static_cast<int>(pyramid.size());
+    for (int level = 0; x0 < x1 && y0 < y1; level++) {
+      if (level == topLevel) {
+        scan(level, x0, y0, x1, y1);
+        break;
+      }
+      // Peel off whatever isn't covered by whole cells of the next level, then move up
+      if (x0 & 1) {
+        scan(level, x0, y0, x0 + 1, y1);
+        x0++;
+      }
+      if ((x1 & 1) && x0 < x1) {
+        scan(level, x1 - 1, y0, x1, y1);
+        x1--;
+      }
+      if (y0 & 1) {
+        scan(level, x0, y0, x1, y0 + 1);
+        y0++;
+      }
+      if ((y1 & 1) && y0 < y1) {
+        scan(level, x0, y1 - 1, x1, y1);
+        y1--;
+      }
+      x0 /= 2;
+      y0 /= 2;
+      x1 /= 2;
+      y1 /= 2;
+    }
+    return range;
+  }
+
+  void Release() {
+    sums = {};
+    ReleaseStatistics();
+    source = nullptr;
+    built = false;
+  }
+
+ private:
+  static constexpr uint64_t LANE = (1u << 21) - 1;
+
+  std::vector<uint64_t> sums;        // (width + 1) × (height + 1), with a row and column of zeros in front
+  std::vector<uint32_t> squares;     // same layout, three per entry
+  std::vector<uint64_t> blockTotals;  // exact table over whole blocks, six per entry (sums, then squares)
+  std::vector<std::vector<Range>> pyramid;  // level 1 (2×2 pixels per cell) and up; level 0 is the snapshot
+  std::vector<int> levelWidths;
+  const DesktopPixels* source = nullptr;
+  int width = 0;
+  int height = 0;
+  bool built = false;
+  bool statistics = false;  // squares, blockTotals and pyramid are there
+  unsigned builtVersion = 0;
+
+  size_t Index(int x, int y) const { return static_cast<size_t>(y) * (width + 1) + x; }
+
+  bool Clip(int& x0, int& y0, int& x1, int& y1) const {
+    x0 = std::max(0, x0);
+    y0 = std::max(0, y0);
+    x1 = std::min(width, x1);
+    y1 = std::min(height, y1);
+    return source && x0 < x1 && y0 < y1;
+  }
+
+  // Exact as long as the rectangle fits in a block, see above
+  void AddPixels(Totals& totals, int x0, int y0, int x1, int y1) const {
+    const size_t a = Index(x0, y0), b = Index(x1, y0), c = Index(x0, y1), d = Index(x1, y1);
+    const uint64_t sum = sums[d] - sums[c] - sums[b] + sums[a];
+    for (int channel = 0; channel < 3; channel++) totals.sum[channel] += (sum >> (channel * 21)) & LANE;
+    if (!statistics) return;
+    for (int channel = 0; channel < 3; channel++) {
+      totals.squares[channel] += static_cast<uint32_t>(squares[d * 3 + channel] - squares[c * 3 + channel] -
+                                                       squares[b * 3 + channel] + squares[a * 3 + channel]);
+    }
+  }
+
+  void AddBlocks(Totals& totals, int blockX0, int blockY0, int blockX1, int blockY1) const {
+    const size_t stride = width / BLOCK + 1;
+    const uint64_t* a = &blockTotals[(blockY0 * stride + blockX0) * 6];
+    const uint64_t* b = &blockTotals[(blockY0 * stride + blockX1) * 6];
+    const uint64_t* c = &blockTotals[(blockY1 * stride + blockX0) * 6];
+    const uint64_t* d = &blockTotals[(blockY1 * stride + blockX1) * 6];
+    for (int channel = 0; channel < 3; channel++) {
+      totals.sum[channel] += d[channel] - c[channel] - b[channel] + a[channel];
+      totals.squares[channel] += d[channel + 3] - c[channel + 3] - b[channel + 3] + a[channel + 3];
+    }
+  }
+
+  Range Cell(int level, int x, int y) const {
+    if (level == 0) {
+      const unsigned char* rgba = source->rgba.data() + (static_cast<size_t>(y) * width + x) * 4;
+      return {{rgba[0], rgba[1], rgba[2]}, {rgba[0], rgba[1], rgba[2]}};
+    }
+    return pyramid[level - 1][static_cast<size_t>(y) * levelWidths[level] + x];
+  }
+
+  static void Merge(Range& range, const Range& other) {
+    for (int channel = 0; channel < 3; channel++) {
+      range.min[channel] = std::min(range.min[channel], other.min[channel]);
+      range.max[channel] = std::max(range.max[channel], other.max[channel]);
+    }
+  }
+
+  void ReleaseStatistics() {
+    squares = {};
+    blockTotals = {};
+    pyramid = {};
+    levelWidths.clear();
+    statistics = false;
+  }
+
+  void BuildSums(const DesktopPixels& pixels, unsigned version) {
+    Profiler().Begin("Integral image");
+    width = pixels.width;
+    height = pixels.height;
+    source = &pixels;
+    built = true;
+    builtVersion = version;
+    ReleaseStatistics();
+    const size_t stride = static_cast<size_t>(width) + 1;
+    sums.assign(stride * (height + 1), 0);
+
+    // Rows are independent for the horizontal prefix sums...
+    SharedWorkerPool().ParallelFor(
+        0, height,
+        [&](int rowBegin, int rowEnd) {
+          for (int y = rowBegin; y < rowEnd; y++) {
+            const unsigned char* rgba = pixels.rgba.data() + static_cast<size_t>(y) * width * 4;
+            uint64_t* sumRow = sums.data() + (y + 1) * stride;
+            uint64_t runningSum = 0;
+            for (int x = 0; x < width; x++, rgba += 4) {
+              runningSum += rgba[0] | (static_cast<uint64_t>(rgba[1]) << 21) | (static_cast<uint64_t>(rgba[2]) << 42);
+              sumRow[x + 1] = runningSum;
+            }
+          }
+        },
+        0, 64);
+
+    // ...and columns for the vertical ones, walked row by row within a band of columns to stay cache friendly
+    SharedWorkerPool().ParallelFor(
+        1, width + 1,
+        [&](int columnBegin, int columnEnd) {
+          for (int y = 2; y <= height; y++) {
+            uint64_t* sumRow = sums.data() + y * stride;
+            const uint64_t* sumAbove = sumRow - stride;
+            for (int x = columnBegin; x < columnEnd; x++) sumRow[x] += sumAbove[x];
+          }
+        },
+        0, 256);
+    Profiler().End();
+  }
+
+  // The tables only the region statistics need, over the snapshot the sums were built from
+  void BuildStatistics(const DesktopPixels& pixels) {
+    Profiler().Begin("Integral image statistics");
+    const size_t stride = static_cast<size_t>(width) + 1;
+    squares.assign(stride * (height + 1) * 3, 0);
+    SharedWorkerPool().ParallelFor(
+        0, height,
+        [&](int rowBegin, int rowEnd) {
+          for (int y = rowBegin; y < rowEnd; y++) {
+            const unsigned char* rgba = pixels.rgba.data() + static_cast<size_t>(y) * width * 4;
+            uint32_t* squareRow = squares.data() + (y + 1) * stride * 3;
+            uint32_t runningSquares[3] = {};
+            for (int x = 0; x < width; x++, rgba += 4) {
+              for (int channel = 0; channel < 3; channel++) {
+                runningSquares[channel] += rgba[channel] * rgba[channel];
+                squareRow[(x + 1) * 3 + channel] = runningSquares[channel];
+              }
+            }
+          }
+        },
+        0, 64);
+    SharedWorkerPool().ParallelFor(
+        1, width + 1,
+        [&](int columnBegin, int columnEnd) {
+          for (int y = 2; y <= height; y++) {
+            uint32_t* squareRow = squares.data() + y * stride * 3;
+            const uint32_t* squareAbove = squareRow - stride * 3;
+            for (int i = columnBegin * 3; i < columnEnd * 3; i++) squareRow[i] += squareAbove[i];
+          }
+        },
+        0, 256);
+    statistics = true;  // AddPixels below needs the squares
+
+    // Exact totals over whole blocks: each block's own sum is exact from the per-pixel tables, then prefix sums
+    const int blocksX = width / BLOCK;
+    const int blocksY = height / BLOCK;
+    const size_t blockStride = blocksX + 1;
+    blockTotals.assign(blockStride * (blocksY + 1) * 6, 0);
+    for (int blockY = 0; blockY < blocksY; blockY++) {
+      for (int blockX = 0; blockX < blocksX; blockX++) {
+        Totals block;
+        AddPixels(block, blockX * BLOCK, blockY * BLOCK, (blockX + 1) * BLOCK, (blockY + 1) * BLOCK);
+        uint64_t* cell = &blockTotals[((blockY + 1) * blockStride + blockX + 1) * 6];
+        const uint64_t* left = cell - 6;
+        const uint64_t* above = cell - blockStride * 6;
+        const uint64_t* aboveLeft = above - 6;
+        for (int channel = 0; channel < 3; channel++) {
+          cell[channel] = block.sum[channel] + left[channel] + above[channel] - aboveLeft[channel];
+          cell[channel + 3] = block.squares[channel] + left[channel + 3] + above[channel + 3] - aboveLeft[channel + 3];
+        }
+      }
+    }
+
+    // Min/max pyramid, up to a single cell
+    pyramid.clear();
+    levelWidths.assign(1, width);
+    int levelWidth = width;
+    int levelHeight = height;
+    for (int level = 1; levelWidth > 1 || levelHeight > 1; level++) {
+      const int previousWidth = levelWidth;
+      const int previousHeight = levelHeight;
+      levelWidth = (levelWidth + 1) / 2;
+      levelHeight = (levelHeight + 1) / 2;
+      levelWidths.push_back(levelWidth);
+      pyramid.emplace_back(static_cast<size_t>(levelWidth) * levelHeight);
+      std::vector<Range>& cells = pyramid.back();
+      SharedWorkerPool().ParallelFor(
+          0, levelHeight,
+          [&](int rowBegin, int rowEnd) {
+            for (int y = rowBegin; y < rowEnd; y++) {
+              for (int x = 0; x < levelWidth; x++) {
+                Range range = Cell(level - 1, x * 2, y * 2);
+                if (x * 2 + 1 < previousWidth) Merge(range, Cell(level - 1, x * 2 + 1, y * 2));
+                if (y * 2 + 1 < previousHeight) {
+                  Merge(range, Cell(level - 1, x * 2, y * 2 + 1));
+                  if (x * 2 + 1 < previousWidth) Merge(range, Cell(level - 1, x * 2 + 1, y * 2 + 1));
+                }
+                cells[static_cast<size_t>(y) * levelWidth + x] = range;
+              }
+            }
+          },
+          0, 32);
+    }
+    Profiler().End();
+  }
+};
+
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ Hover color picker (P). Reads the pixel under the cursor, or the average of the N×N block around it ([ and ]     │
+ * │ change N from 1 up to 31), from the integral images of the CPU snapshot, so it never reads back from the GPU and │
+ * │ costs the same whatever N is.                                                                                    │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+class ColorPicker {
+ public:
+  static constexpr int MAX_KERNEL = 31;
+
+  bool enabled = false;
+  int kernel = 1;  // odd, so the cursor pixel is the center
+  bool valid = false;
+  Color color = BLACK;
+
+  void Toggle() {
+    enabled = !enabled;
+    valid = false;
+  }
+
+  void GrowKernel() { kernel = std::min(MAX_KERNEL, kernel + 2); }
+  void ShrinkKernel() { kernel = std::max(1, kernel - 2); }
+
+  // Samples around the given desktop pixel
+  void Update(const IntegralImage& integral, int x, int y) {
+    valid = false;
+    if (!enabled || !integral.Ready()) return;
+    if (x < 0 || y < 0 || x >= integral.Width() || y >= integral.Height()) return;
+
+    const int half = kernel / 2;
+    IntegralImage::Totals totals = integral.Sum(x - half, y - half, x + half + 1, y + half + 1);
+    auto average = [&](int channel) {
+      return static_cast<unsigned char>((totals.sum[channel] + totals.count / 2) / totals.count);
+    };
+    color = {average(0), average(1), average(2), 255};
+    valid = true;
+  }
+
+  const char* Describe() const {
+    if (!enabled) return "off";
+    if (!valid) return "-";
+    Vector3 hsv = ColorToHSV(color);
+    return TextFormat("#%02X%02X%02X rgb(%d, %d, %d) hsv(%.0f, %.0f%%, %.0f%%) %dx%d", color.r, color.g, color.b,
+                      color.r, color.g, color.b, hsv.x, hsv.y * 100.0f, hsv.z * 100.0f, kernel, kernel);
+  }
+
+  void CopyToClipboard() const {
+    if (!valid) return;
+    const char* hex = TextFormat("#%02X%02X%02X", color.r, color.g, color.b);
+    SetClipboardText(hex);
+    std::cout << "Copied " << hex << " to the clipboard" << std::endl;
+  }
+
+  // Outlines the sampled block on screen, so it's clear what is being averaged
+  void DrawKernelOutline(Vector2 pan, float zoom, int x, int y) const {
+    if (!enabled) return;
+    const int half = kernel / 2;
+    Rectangle outline = {(x - half - pan.x) * zoom, (y - half - pan.y) * zoom, kernel * zoom, kernel * zoom};
+    DrawRectangleLinesEx(outline, 1.0f, valid ? (ColorToHSV(color).z > 0.5f ? BLACK : WHITE) : RED);
+  }
+};
+
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ Region statistics (Shift+drag). Selects a rectangle of desktop pixels and reports the mean, standard deviation,  │
+ * │ min and max of each channel, handy to spot banding in a gradient or to check that a fill is really flat. The     │
+ * │ numbers come from the integral images and are only recomputed when the selection or the snapshot changes.        │
+ * │ A Shift+click without dragging clears the selection.                                                             │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+class RegionSelection {
+ public:
+  bool selecting = false;
+
+  bool Active() const { return selecting || hasSelection; }
+
+  // The selected pixels, in desktop coordinates
+  Rectangle Area() const {
+    int left, top, right, bottom;
+    Bounds(left, top, right, bottom);
+    return {static_cast<float>(left), static_cast<float>(top), static_cast<float>(right - left),
+            static_cast<float>(bottom - top)};
+  }
+
+  void Begin(Vector2 onTexture) {
+    selecting = true;
+    hasSelection = false;
+    anchor = onTexture;
+    corner = onTexture;
+    totals = {};
+    computedVersion = 0;
+  }
+
+  void Drag(Vector2 onTexture) {
+    if (selecting) corner = onTexture;
+  }
+
+  void End() {
+    if (!selecting) return;
+    selecting = false;
+    int left, top, right, bottom;
+    Bounds(left, top, right, bottom);
+    hasSelection = right - left > 1 || bottom - top > 1;
+  }
+
+  // Recomputes the statistics if the selection or the integral images changed since the last call
+  void Update(const IntegralImage& integral, unsigned version) {
+    if (!Active() || !integral.Ready()) return;
+    int left, top, right, bottom;
+    Bounds(left, top, right, bottom);
+    if (version == computedVersion && left == x0 && top == y0 && right == x1 && bottom == y1) return;
+
+    x0 = left;
+    y0 = top;
+    x1 = right;
+    y1 = bottom;
+    computedVersion = version;
+    totals = integral.Sum(x0, y0, x1, y1);
+    range = integral.MinMax(x0, y0, x1, y1);
+  }
+
+  const char* DescribeArea() const {
+    if (!Active()) return "shift+drag";
+    if (totals.count == 0) return "-";
+    return TextFormat("%dx%d at %d, %d (%llu px)", x1 - x0, y1 - y0, x0, y0,
+                      static_cast<unsigned long long>(totals.count));
+  }
+
+  const char* DescribeChannel(int channel) const {
+    if (!Active() || totals.count == 0) return "-";
+    const double count = static_cast<double>(totals.count);
+    const double mean = totals.sum[channel] / count;
+    const double variance = std::max(0.0, totals.squares[channel] / count - mean * mean);
+    return TextFormat("mean %6.2f  sd %6.2f  min %3d  max %3d", mean, std::sqrt(variance), range.min[channel],
+                      range.max[channel]);
+  }
+
+  void Draw(Vector2 pan, float zoom) const {
+    if (!Active()) return;
+    int left, top, right, bottom;
+    Bounds(left, top, right, bottom);
+    Rectangle outline = {(left - pan.x) * zoom, (top - pan.y) * zoom, (right - left) * zoom, (bottom - top) * zoom};
+    DrawRectangleRec(outline, Fade(SKYBLUE, 0.15f));
+    DrawRectangleLinesEx(outline, 1.0f, SKYBLUE);
+  }
+
+ private:
+  bool hasSelection = false;
+  Vector2 anchor = {0, 0};
+  Vector2 corner = {0, 0};
+  int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+  unsigned computedVersion = 0;
+  IntegralImage::Totals totals;
+  IntegralImage::Range range = {};
+
+  // Whole pixels covered from the anchor to the corner, both included
+  void Bounds(int& left, int& top, int& right, int& bottom) const {
+    left = static_cast<int>(std::floor(std::min(anchor.x, corner.x)));
+    top = static_cast<int>(std::floor(std::min(anchor.y, corner.y)));
+    right = static_cast<int>(std::floor(std::max(anchor.x, corner.x))) + 1;
+    bottom = static_cast<int>(std::floor(std::max(anchor.y, corner.y))) + 1;
+  }
+};
+
+// Whole pixels of area (in desktop coordinates, possibly fractional or past the edges) that lie on the desktop
+Rectangle ClipToPixels(Rectangle area, int width, int height) {
+  const float left = std::max(0.0f, std::floor(area.x));
+  const float top = std::max(0.0f, std::floor(area.y));
+  const float right = std::min(static_cast<float>(width), std::ceil(area.x + area.width));
+  const float bottom = std::min(static_cast<float>(height), std::ceil(area.y + area.height));
+  return {left, top, std::max(0.0f, right - left), std::max(0.0f, bottom - top)};
+}
+
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ Histogram overlay (H) of R, G, B and luma over what's on screen, or over the selection when there is one, drawn  │
+ * │ next to the debug panel. Binning runs on the worker pool, each band into its own private histogram so threads    │
+ * │ never share a counter, merged at the end. When the view pans, only the strips that scrolled in are added and the │
+ * │ ones that scrolled out subtracted; it starts over when the snapshot changes or when that would be more work.     │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+class HistogramOverlay {
+ public:
+  static constexpr int GRAPH_HEIGHT = 40;
+
+  bool enabled = false;
+
+  void Toggle() {
+    enabled = !enabled;
+    valid = false;
+  }
+
+  // area is in desktop pixels and gets clipped to the snapshot
+  void Update(const DesktopPixels* pixels, unsigned version, Rectangle area) {
+    if (!enabled || !pixels) return;
+    Rectangle clipped = ClipToPixels(area, pixels->width, pixels->height);
+    if (valid && version == binnedVersion && clipped.x == binned.x && clipped.y == binned.y &&
+        clipped.width == binned.width && clipped.height == binned.height) {
+      return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Rectangle> added;
+    std::vector<Rectangle> removed;
+    if (valid && version == binnedVersion) {
+      added = SubtractRectangle(clipped, binned);
+      removed = SubtractRectangle(binned, clipped);
+    }
+    float changedArea = 0.0f;
+    for (const Rectangle& part : added) changedArea += part.width * part.height;
+    for (const Rectangle& part : removed) changedArea += part.width * part.height;
+
+    incremental = valid && version == binnedVersion && changedArea < clipped.width * clipped.height;
+    if (incremental) {
+      for (const Rectangle& part : added) Accumulate(*pixels, part, 1);
+      for (const Rectangle& part : removed) Accumulate(*pixels, part, -1);
+    } else {
+      std::fill(&counts[0][0], &counts[0][0] + ChannelHistograms::CHANNEL_COUNT * 256, 0);
+      Accumulate(*pixels, clipped, 1);
+    }
+    binned = clipped;
+    binnedVersion = version;
+    valid = true;
+    updateMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  const char* Describe() const {
+    if (!enabled) return "off";
+    if (!valid) return "-";
+    return TextFormat("%.0fx%.0f, %s in %.2f ms", binned.width, binned.height, incremental ? "incremental" : "full",
+                      updateMs);
+  }
+
+  // Stacked graphs, one column per bin. The scale is the square root of the count, or a flat background would
+  // flatten everything else into the baseline.
+  void Draw(Rectangle nextTo) const {
+    if (!enabled || !valid) return;
+    const int gap = 8;
+    const int width = 256 + gap * 2;
+    const int height = (GRAPH_HEIGHT + gap) * ChannelHistograms::CHANNEL_COUNT + gap;
+    int left = static_cast<int>(nextTo.x + nextTo.width) + gap;
+    if (left + width > GetScreenWidth()) left = static_cast<int>(nextTo.x) - gap - width;
+    const int top = static_cast<int>(nextTo.y);
+
+    DrawRectangle(left, top, width, height, Fade(BLACK, 0.6667f));
+    DrawRectangleLines(left, top, width, height, WHITE);
+
+    const Color colors[ChannelHistograms::CHANNEL_COUNT] = {RED, GREEN, SKYBLUE, LIGHTGRAY};
+    for (int channel = 0; channel < ChannelHistograms::CHANNEL_COUNT; channel++) {
+      const uint64_t peak = *std::max_element(counts[channel], counts[channel] + 256);
+      if (peak == 0) continue;
+      const float scale = GRAPH_HEIGHT / std::sqrt(static_cast<float>(peak));
+      const int bottom = top + (GRAPH_HEIGHT + gap) * (channel + 1);
+      for (int bin = 0; bin < 256; bin++) {
+        const int barHeight = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(counts[channel][bin])) * scale));
+        if (barHeight > 0) DrawLine(left + gap + bin, bottom, left + gap + bin, bottom - barHeight, colors[channel]);
+      }
+    }
+  }
+
+ private:
+  uint64_t counts[ChannelHistograms::CHANNEL_COUNT][256] = {};
+  Rectangle binned = {0, 0, 0, 0};
+  unsigned binnedVersion = 0;
+  bool valid = false;
+  bool incremental = false;
+  float updateMs = 0.0f;
+
+  // Adds (sign = 1) or removes (sign = -1) the pixels of part, which must lie inside the snapshot
+  void Accumulate(const DesktopPixels& pixels, Rectangle part, int sign) {
+    const int x0 = static_cast<int>(part.x);
+    const int y0 = static_cast<int>(part.y);
+    const int columns = static_cast<int>(part.width);
+    std::mutex mergeMutex;
+    SharedWorkerPool().ParallelFor(
+        y0, y0 + static_cast<int>(part.height),
+        [&](int rowBegin, int rowEnd) {
+          auto histograms = std::make_unique<ChannelHistograms>();  // value-initialized, so all zeros
+          for (int y = rowBegin; y < rowEnd; y++) {
+            BinRGBA(pixels.rgba.data() + (static_cast<size_t>(y) * pixels.width + x0) * 4, columns, *histograms);
+          }
+          std::lock_guard<std::mutex> lock(mergeMutex);
+          for (int channel = 0; channel < ChannelHistograms::CHANNEL_COUNT; channel++) {
+            for (int bin = 0; bin < 256; bin++) counts[channel][bin] += sign * int64_t{histograms->bins[channel][bin]};
+          }
+        },
+        0, 16);
+  }
+};
+
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ Color vision simulation (C cycles through the modes). The desktop is drawn through a fragment shader that looks  │
+ * │ each color up in a 3D LUT of the simulation, so any mode costs one extra (hardware trilinear) texture fetch per  │
+ * │ screen pixel at any zoom. A mode's LUT is built from the CPU reference the first time it's picked (a few ms) and │
+ * │ kept for the rest of the session. rlgl has no 3D textures, so those are plain GL calls.                          │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+class ColorVisionFilter {
+ public:
+  static constexpr int LUT_SIZE = 65;
+
+  ColorVision mode = ColorVision::NORMAL;
+
+  bool Available() const { return shader.id != 0; }
+
+  void Cycle() {
+    if (!loaded) Load();
+    if (shader.id == 0) return;
+    mode = static_cast<ColorVision>((static_cast<int>(mode) + 1) % static_cast<int>(ColorVision::COUNT));
+    if (mode != ColorVision::NORMAL && luts[static_cast<int>(mode)] == 0) LoadLut(mode);
+  }
+
+  // Wraps the draw calls that should be seen through the current mode
+  void Begin() {
+    active = mode != ColorVision::NORMAL && shader.id != 0;
+    if (!active) return;
+    BeginShaderMode(shader);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_3D, luts[static_cast<int>(mode)]);
+    glActiveTexture(GL_TEXTURE0);
+  }
+
+  void End() {
+    if (!active) return;
+    EndShaderMode();  // flushes the batch, so the LUT is still bound for the draws above
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_3D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    active = false;
+  }
+
+  void Unload() {
+    for (unsigned int& lut : luts) {
+      if (lut != 0) glDeleteTextures(1, &lut);
+      lut = 0;
+    }
+    if (shader.id != 0) UnloadShader(shader);
+    shader = {0};
+    loaded = false;
+  }
+
+ private:
+  static constexpr const char* LUT_SHADER = R"(#version 330
+in vec2 fragTexCoord;
+in vec4 fragColor;
+uniform sampler2D texture0;
+uniform sampler3D lut;
+uniform vec4 colDiffuse;
+uniform float lutScale;
+uniform float lutOffset;
+out vec4 finalColor;
+void main() {
+  vec4 texel = texture(texture0, fragTexCoord) * colDiffuse * fragColor;
+  finalColor = vec4(texture(lut, texel.rgb * lutScale + lutOffset).rgb, texel.a);
+}
+)";
+
+  bool loaded = false;
+  bool active = false;
+  Shader shader = {0};
+  unsigned int luts[static_cast<int>(ColorVision::COUNT)] = {};
+
+  void Load() {
+    loaded = true;
+    int version = rlGetVersion();
+    if (version == RL_OPENGL_33 || version == RL_OPENGL_43) {
+      shader = LoadShaderFromMemory(nullptr, LUT_SHADER);
+      if (shader.id == rlGetShaderIdDefault()) shader = {0};
+    }
+    if (shader.id == 0) {
+      std::cerr << "Color vision shader unavailable, simulation disabled" << std::endl;
+      return;
+    }
+
+    // Texel centers, so 0 and 1 land exactly on the first and last entries
+    const int lutUnit = 1;
+    const float lutScale = (LUT_SIZE - 1.0f) / LUT_SIZE;
+    const float lutOffset = 0.5f / LUT_SIZE;
+    SetShaderValue(shader, GetShaderLocation(shader, "lut"), &lutUnit, SHADER_UNIFORM_INT);
+    SetShaderValue(shader, GetShaderLocation(shader, "lutScale"), &lutScale, SHADER_UNIFORM_FLOAT);
+    SetShaderValue(shader, GetShaderLocation(shader, "lutOffset"), &lutOffset, SHADER_UNIFORM_FLOAT);
+  }
+
+  void LoadLut(ColorVision vision) {
+    StartupProfiler::Scope phase(Profiler(), "Color vision LUT");
+    std::vector<unsigned char> lut = BuildColorVisionLut(vision, LUT_SIZE);
+
+    unsigned int& id = luts[static_cast<int>(vision)];
+    glGenTextures(1, &id);
+    glBindTexture(GL_TEXTURE_3D, id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);  // rows of 65 RGB texels aren't 4-byte aligned
+    glTexImage3D(GL_TEXTURE_3D, 0, GL_RGB8, LUT_SIZE, LUT_SIZE, LUT_SIZE, 0, GL_RGB, GL_UNSIGNED_BYTE, lut.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_3D, 0);
+  }
+};
+
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ Daltonization preview (D cycles off, corrected, corrected as seen through the simulation). The desktop is drawn  │
+ * │ into a screen-sized render texture first, then chained passes run over that: simulate it through the color       │
+ * │ vision LUT, take the error against the original and shift it into channels the viewer can see, and finally       │
+ * │ composite the result (simulated once more in the last mode) on screen. Only what's visible is processed, at      │
+ * │ screen resolution, so the cost doesn't depend on the size of the desktop. It corrects for the deficiency picked  │
+ * │ with C; there is nothing to correct for normal vision or achromatopsia.                                          │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+class DaltonizePipeline {
+ public:
+  enum class Mode { OFF, CORRECTED, CORRECTED_SIMULATED, COUNT };
+
+  Mode mode = Mode::OFF;
+
+  void Cycle() {
+    if (!loaded) Load();
+    if (shader.id == 0) return;
+    mode = static_cast<Mode>((static_cast<int>(mode) + 1) % static_cast<int>(Mode::COUNT));
+  }
+
+  bool Active(const ColorVisionFilter& vision) const {
+    float shift[3][3];
+    return mode != Mode::OFF && shader.id != 0 && vision.Available() && DaltonizeShift(vision.mode, shift);
+  }
+
+  const char* Describe(const ColorVisionFilter& vision) const {
+    if (mode == Mode::OFF) return "off";
+    if (!Active(vision)) return TextFormat("nothing to correct for %s", ColorVisionName(vision.mode));
+    return TextFormat("%s (%s)", mode == Mode::CORRECTED ? "corrected" : "corrected, simulated",
+                      ColorVisionName(vision.mode));
+  }
+
+  // Everything drawn between BeginScene and EndScene goes through the passes
+  void BeginScene(int width, int height) {
+    if (scene.id == 0 || scene.texture.width != width || scene.texture.height != height) Resize(width, height);
+    BeginTextureMode(scene);
+    ClearBackground(BLACK);
+  }
+
+  void EndScene(ColorVisionFilter& vision) {
+    EndTextureMode();
+
+    // Pass 1: what the viewer sees
+    BeginTextureMode(simulated);
+    vision.Begin();
+    DrawPass(scene.texture);
+    vision.End();
+    EndTextureMode();
+
+    // Pass 2: the error they miss, shifted into the channels they see and added back
+    float shift[3][3];
+    DaltonizeShift(vision.mode, shift);
+    SetShaderValueV(shader, shiftLocation, shift, SHADER_UNIFORM_VEC3, 3);
+    BeginTextureMode(corrected);
+    BeginShaderMode(shader);
+    SetShaderValueTexture(shader, simulatedLocation, simulated.texture);
+    DrawPass(scene.texture);
+    EndShaderMode();
+    EndTextureMode();
+
+    // Pass 3: composite, optionally through the simulation again to see whether the correction helps
+    if (mode == Mode::CORRECTED_SIMULATED) vision.Begin();
+    DrawPass(corrected.texture);
+    if (mode == Mode::CORRECTED_SIMULATED) vision.End();
+  }
+
+  void Unload() {
+    UnloadTargets();
+    if (shader.id != 0) UnloadShader(shader);
+    shader = {0};
+    loaded = false;
+  }
+
+ private:
+  static constexpr const char* DALTONIZE_SHADER = R"(#version 330
+in vec2 fragTexCoord;
+uniform sampler2D texture0;
+uniform sampler2D simulated;
+uniform vec3 shift[3];
+out vec4 finalColor;
+vec3 toLinear(vec3 c) { return mix(c / 12.92, pow((c + 0.055) / 1.055, vec3(2.4)), step(0.04045, c)); }
+vec3 toSRGB(vec3 c) {
+  c = clamp(c, 0.0, 1.0);
+  return mix(c * 12.92, 1.055 * pow(c, vec3(1.0 / 2.4)) - 0.055, step(0.0031308, c));
+}
+void main() {
+  vec3 original = toLinear(texture(texture0, fragTexCoord).rgb);
+  vec3 error = original - toLinear(texture(simulated, fragTexCoord).rgb);
+  finalColor = vec4(toSRGB(original + vec3(dot(shift[0], error), dot(shift[1], error), dot(shift[2], error))), 1.0);
+}
+)";
+
+  bool loaded = false;
+  Shader shader = {0};
+  int shiftLocation = -1;
+  int simulatedLocation = -1;
+  RenderTexture2D scene = {0};
+  RenderTexture2D simulated = {0};
+  RenderTexture2D corrected = {0};
+
+  void Load() {
+    loaded = true;
+    int version = rlGetVersion();
+    if (version == RL_OPENGL_33 || version == RL_OPENGL_43) {
+      shader = LoadShaderFromMemory(nullptr, DALTONIZE_SHADER);
+      if (shader.id == rlGetShaderIdDefault()) shader = {0};
+    }
+    if (shader.id == 0) {
+      std::cerr << "Daltonization shader unavailable, correction preview disabled" << std::endl;
+      return;
+    }
+    shiftLocation = GetShaderLocation(shader, "shift");
+    simulatedLocation = GetShaderLocation(shader, "simulated");
+  }
+
+  void Resize(int width, int height) {
+    UnloadTargets();
+    scene = LoadRenderTexture(width, height);
+    simulated = LoadRenderTexture(width, height);
+    corrected = LoadRenderTexture(width, height);
+  }
+
+  void UnloadTargets() {
+    for (RenderTexture2D* target : {&scene, &simulated, &corrected}) {
+      if (target->id != 0) UnloadRenderTexture(*target);
+      *target = {0};
+    }
+  }
+
+  // Render textures are stored bottom-up, hence the negative height; every pass flips, so they all line up
+  static void DrawPass(Texture2D texture) {
+    DrawTextureRec(texture, {0, 0, static_cast<float>(texture.width), -static_cast<float>(texture.height)}, {0, 0},
+                   WHITE);
+  }
+};
+
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ PNG export (S for the view at native resolution, Shift+S for the whole desktop). The render loop only grabs the  │
+ * │ pixels (the desktop snapshot shared with the overlays, read back once if nobody has one; for the view, just its  │
+ * │ rectangle) and hands them to a thread that encodes them with the parallel strip writer, so the view keeps moving │
+ * │ while it works. Progress and the output path show up in the debug panel. One export at a time, and none while    │
+ * │ the background capture is still streaming regions in.                                                            │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+class PngExporter {
+ public:
+  std::string directory = ".";
+
+  ~PngExporter() { Wait(); }
+
+  bool Busy() const { return running; }
+
+  void Start(std::shared_ptr<const DesktopPixels> pixels, Rectangle region, const char* what) {
+    if (running) {
+      std::cerr << "An export is already running" << std::endl;
+      return;
+    }
+    if (!pixels || region.width <= 0 || region.height <= 0) return;
+    Wait();
+
+    char stamp[32];
+    std::time_t now = std::time(nullptr);
+    std::tm local;
+    localtime_r(&now, &local);
+    std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &local);
+    path = directory + "/urblind-" + stamp + "-" + what + ".png";
+    started = true;
+    running = true;
+
+    thread = std::thread([this, pixels, region]() {
+      auto start = std::chrono::steady_clock::now();
+      const int x = static_cast<int>(region.x);
+      const int y = static_cast<int>(region.y);
+      const unsigned char* topLeft = pixels->rgba.data() + (static_cast<size_t>(y) * pixels->width + x) * 4;
+      // Leave a core to the render loop
+      const unsigned threads = std::max(2u, std::thread::hardware_concurrency()) - 1;
+      succeeded = WritePng(path, topLeft, static_cast<int>(region.width), static_cast<int>(region.height),
+                           pixels->width, progress, threads);
+      elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+      if (succeeded) {
+        std::cout << "Exported " << path << " in " << TextFormat("%.0f", elapsedMs) << " ms" << std::endl;
+      } else {
+        std::cerr << "Failed to export " << path << std::endl;
+      }
+      running = false;
+    });
+  }
+
+  const char* Describe() const {
+    if (!started) return "S: view, shift+S: desktop";
+    if (running) {
+      const int count = std::max(1, progress.stripCount.load());
+      return TextFormat("%3d%% %s", progress.stripsDone * 100 / count, path.c_str());
+    }
+    if (!succeeded) return TextFormat("failed %s", path.c_str());
+    return TextFormat("%s in %.0f ms", path.c_str(), elapsedMs);
+  }
+
+  void Wait() {
+    if (thread.joinable()) thread.join();
+  }
+
+ private:
+  std::thread thread;
+  std::atomic<bool> running{false};
+  bool started = false;
+  PngProgress progress;
+  // Written by the export thread before it clears running, and only read once running is false
+  std::string path;
+  bool succeeded = false;
+  double elapsedMs = 0.0;
+};
+
+void SetupUTF8() { std::locale::global(std::locale("en_US.UTF-8")); }
+
+void DrawMonitorLayout(const MonitorState& monitorState) {
+  SetupUTF8();
+
+  // Get terminal width
+  struct winsize w;
+  ioctl(STDOUT_FILENO, TIOCGWINSZ, &w);
+  int termWidth = w.ws_col - 4;
+
+  if (termWidth <= 0) {
+    std::cerr << "Unable to detect terminal width!" << std::endl;
+    return;
+  }
+
+  int monitorCount = monitorState.spatialMonitorIndexes.size();
+  if (monitorCount == 0) {
+    std::cerr << "No monitors detected!" << std::endl;
+    return;
+  }
+
+  // Determine total pixel width of all monitors
+  float totalWidthPixels = 0;
+  for (int idx : monitorState.spatialMonitorIndexes) {
+    totalWidthPixels += monitorState.resolutions[idx].x;
+  }
+
+  // Compute proportional width of each monitor box
+  std::vector<int> boxWidths(monitorCount);
+  std::vector<int> boxHeights(monitorCount);
+  float scaleFactor = static_cast<float>(termWidth) / totalWidthPixels;
+
+  int maxBoxHeight = 10;  // Fixed height for boxes
+  for (int i = 0; i < monitorCount; i++) {
+    int realIndex = monitorState.spatialMonitorIndexes[i];  // Real index
+    boxWidths[i] = std::max(10, static_cast<int>(monitorState.resolutions[realIndex].x * scaleFactor));
+    boxHeights[i] = maxBoxHeight;
+  }
+
+  // Define Unicode box-drawing characters as UTF-8 strings
+  const std::string topLeft = "┌";
+  const std::string topRight = "┐";
+  const std::string bottomLeft = "└";
+  const std::string bottomRight = "┘";
+  const std::string horizontal = "─";
+  const std::string vertical = "│";
+
+  // Draw monitor layout to the terminal
+  for (int row = 0; row < maxBoxHeight; row++) {
+    std::string line;
+    for (int i = 0; i < monitorCount; i++) {
+      int realIndex = monitorState.spatialMonitorIndexes[i];  // Get real index in order
+      std::string resolutionLabel = std::to_string(static_cast<int>(monitorState.resolutions[realIndex].x)) + "x" +
+                                    std::to_string(static_cast<int>(monitorState.resolutions[realIndex].y));
+
+      std::string spatialIndexLabel = "[" + std::to_string(i) + "]";  // Spatial index for ordering
+
+      int padding = boxWidths[i] - 2 - resolutionLabel.size();
+      int bottomPadding = boxWidths[i] - 2 - spatialIndexLabel.size();
+
+      if (row == 0) {  // Top border
+        line += topLeft + resolutionLabel;
+        for (int j = 0; j < padding; j++) {
+          line += horizontal;
+        }
+        line += topRight + " ";
+      } else if (row == maxBoxHeight - 1) {  // Bottom border with spatial index
+        line += bottomLeft + spatialIndexLabel;
+        for (int j = 0; j < bottomPadding; j++) {
+          line += horizontal;
+        }
+        line += bottomRight + " ";
+      } else {  // Empty box space
+        line += vertical + std::string(boxWidths[i] - 2, ' ') + vertical + " ";
+      }
+    }
+    std::cout << line << std::endl;
+  }
+  std::cout.flush();
+}
+
+// Same trick as with XShmAttach: XGrabKey fails asynchronously (BadAccess) when some other client owns the key
+static bool xGrabKeyFailed = false;
+
+int HandleGrabKeyError(Display* display, XErrorEvent* event) {
+  xGrabKeyFailed = true;
+  return 0;
+}
+
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ Daemon mode plumbing. Instead of paying for the window, GL context, monitor query and font every time we want to │
+ * │ zoom, a resident urblind sits hidden and waits here for any of three triggers: a global X key grab (--hotkey),   │
+ * │ a line on its UNIX socket (what `urblind --trigger [monitor_index]` sends), or a SIGUSR1.                        │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+class ActivationListener {
+ public:
+  static constexpr int DEFAULT_MONITOR = -1;
+
+  ~ActivationListener() { Stop(); }
+
+  static std::string SocketPath() {
+    const char* runtimeDir = std::getenv("XDG_RUNTIME_DIR");
+    if (runtimeDir && *runtimeDir) return std::string(runtimeDir) + "/urblind.sock";
+    return "/tmp/urblind-" + std::to_string(getuid()) + ".sock";
+  }
+
+  // Client side: asks a running daemon to show up on the given spatial monitor index
+  static bool SendTrigger(int monitorIndex) {
+    int fd = ConnectSocket();
+    if (fd < 0) {
+      std::cerr << "No urblind daemon is listening on " << SocketPath() << std::endl;
+      return false;
+    }
+    std::string message = std::to_string(monitorIndex) + "\n";
+    bool sent = write(fd, message.data(), message.size()) == static_cast<ssize_t>(message.size());
+    close(fd);
+    return sent;
+  }
+
+  bool Start(const std::string& hotkey) {
+    // Self-pipe, so the signal handler only has to write a byte and Wait() can poll() for it with everything else
+    if (pipe(signalPipe) != 0) {
+      std::cerr << "Failed to create the signal pipe!" << std::endl;
+      return false;
+    }
+    fcntl(signalPipe[0], F_SETFL, O_NONBLOCK);
+    fcntl(signalPipe[1], F_SETFL, O_NONBLOCK);
+    signalWriteFd = signalPipe[1];
+
+    struct sigaction action = {};
+    action.sa_handler = HandleSignal;
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGUSR1, &action, nullptr);
+
+    std::string path = SocketPath();
+    int existing = ConnectSocket();
+    if (existing >= 0) {
+      close(existing);
+      std::cerr << "Another urblind daemon is already listening on " << path << std::endl;
+      return false;
+    }
+    unlink(path.c_str());  // stale socket left behind by a daemon that didn't exit cleanly
+
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenSocket < 0 || bind(listenSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listenSocket, 4) != 0) {
+      std::cerr << "Failed to listen on " << path << ": " << std::strerror(errno) << std::endl;
+      return false;
+    }
+    fcntl(listenSocket, F_SETFL, O_NONBLOCK);
+    std::cout << "Daemon listening on " << path << " (and SIGUSR1)" << std::endl;
+
+    if (!hotkey.empty() && !GrabHotkey(hotkey)) return false;
+    return true;
+  }
+
+  // Blocks until something asks us to show up. Returns the requested spatial monitor index or DEFAULT_MONITOR.
+  int Wait() {
+    while (true) {
+      // Key presses may already be sitting in Xlib's queue, where poll() can't see them
+      if (display && TakeHotkeyPresses()) return DEFAULT_MONITOR;
+
+      pollfd fds[3] = {{signalPipe[0], POLLIN, 0}, {listenSocket, POLLIN, 0}, {-1, POLLIN, 0}};
+      if (display) fds[2].fd = ConnectionNumber(display);
+
+      if (poll(fds, 3, -1) < 0) {
+        if (errno == EINTR) continue;
+        std::cerr << "poll() failed: " << std::strerror(errno) << std::endl;
+        return DEFAULT_MONITOR;
+      }
+
+      if (fds[0].revents & POLLIN) {
+        DrainSignalPipe();
+        return DEFAULT_MONITOR;
+      }
+
+      if (fds[1].revents & POLLIN) {
+        std::optional<int> requested = AcceptTrigger();
+        if (requested) return *requested;
+      }
+    }
+  }
+
+  // Throws away whatever triggers piled up while the window was visible
+  void Drain() {
+    DrainSignalPipe();
+    while (AcceptTrigger()) {
+    }
+    if (display) TakeHotkeyPresses();
+  }
+
+  void Stop() {
+    if (display) {
+      XCloseDisplay(display);
+      display = nullptr;
+    }
+    if (listenSocket >= 0) {
+      close(listenSocket);
+      unlink(SocketPath().c_str());
+      listenSocket = -1;
+    }
+    for (int& fd : signalPipe) {
+      if (fd >= 0) close(fd);
+      fd = -1;
+    }
+    signalWriteFd = -1;
+  }
+
+ private:
+  int listenSocket = -1;
+  int signalPipe[2] = {-1, -1};
+  Display* display = nullptr;
+
+  static inline volatile sig_atomic_t signalWriteFd = -1;
+
+  static void HandleSignal(int signal) {
+    char byte = 1;
+    if (signalWriteFd >= 0) (void)!write(signalWriteFd, &byte, 1);
+  }
+
+  static int ConnectSocket() {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, SocketPath().c_str(), sizeof(address.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+      close(fd);
+      return -1;
+    }
+    return fd;
+  }
+
+  void DrainSignalPipe() {
+    char buffer[64];
+    while (read(signalPipe[0], buffer, sizeof(buffer)) > 0) {
+    }
+  }
+
+  std::optional<int> AcceptTrigger() {
+    int client = accept(listenSocket, nullptr, nullptr);
+    if (client < 0) return std::nullopt;
+
+    // Don't let a client that connects and never writes hang the daemon
+    timeval timeout = {0, 100000};
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    char buffer[32] = {};
+    ssize_t length = read(client, buffer, sizeof(buffer) - 1);
+    close(client);
+
+    if (length <= 0) return DEFAULT_MONITOR;
+    return std::atoi(buffer);
+  }
+
+  bool TakeHotkeyPresses() {
+    bool pressed = false;
+    while (XPending(display)) {
+      XEvent event;
+      XNextEvent(display, &event);
+      if (event.type == KeyPress) pressed = true;
+    }
+    return pressed;
+  }
+
+  // Accepts specs like "Mod4+z", "ctrl+alt+Print" or "F12": modifiers joined by '+', then an X keysym name
+  bool GrabHotkey(const std::string& spec) {
+    display = XOpenDisplay(nullptr);
+    if (!display) {
+      std::cerr << "Cannot open X11 display for the hotkey grab!" << std::endl;
+      return false;
+    }
+
+    unsigned int modifiers = 0;
+    std::string keyName;
+    size_t start = 0;
+    while (true) {
+      size_t plus = spec.find('+', start);
+      std::string token = spec.substr(start, plus == std::string::npos ? std::string::npos : plus - start);
+      if (plus == std::string::npos) {
+        keyName = token;
+        break;
+      }
+      std::transform(token.begin(), token.end(), token.begin(), ::tolower);
+      if (token == "shift") {
+        modifiers |= ShiftMask;
+      } else if (token == "ctrl" || token == "control") {
+        modifiers |= ControlMask;
+      } else if (token == "alt" || token == "mod1") {
+        modifiers |= Mod1Mask;
+      } else if (token == "super" || token == "mod4") {
+        modifiers |= Mod4Mask;
+      } else {
+        std::cerr << "Unknown hotkey modifier: " << token << std::endl;
+        return false;
+      }
+      start = plus + 1;
+    }
+
+    KeySym keysym = XStringToKeysym(keyName.c_str());
+    KeyCode keycode = keysym == NoSymbol ? 0 : XKeysymToKeycode(display, keysym);
+    if (keycode == 0) {
+      std::cerr << "Unknown hotkey key: " << keyName << std::endl;
+      return false;
+    }
+
+    // Grab it with every combination of CapsLock and NumLock, otherwise it silently stops working when they're on
+    Window root = DefaultRootWindow(display);
+    xGrabKeyFailed = false;
+    XErrorHandler previousHandler = XSetErrorHandler(HandleGrabKeyError);
+    for (unsigned int locks : {0u, static_cast<unsigned int>(LockMask), static_cast<unsigned int>(Mod2Mask),
+                               static_cast<unsigned int>(LockMask | Mod2Mask)}) {
+      XGrabKey(display, keycode, modifiers | locks, root, True, GrabModeAsync, GrabModeAsync);
+    }
+    XSync(display, False);
+    XSetErrorHandler(previousHandler);
+
+    if (xGrabKeyFailed) {
+      std::cerr << "Hotkey " << spec << " is already grabbed by another client!" << std::endl;
+      return false;
+    }
+    std::cout << "Hotkey grabbed: " << spec << std::endl;
+    return true;
+  }
+};
+
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ --bench-convert: times the BGRX → RGBA conversion on synthetic 1080p, 4K and triple-4K frames for 1, 2, 4, ...   │
+ * │ threads up to the pool size, so we can see where it stops scaling on a given machine. No X or GL needed.         │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+void RunConvertBenchmark() {
+  struct BenchSize {
+    const char* name;
+    int width, height;
+  };
+  const BenchSize sizes[] = {{"1080p", 1920, 1080}, {"4K", 3840, 2160}, {"3x4K", 11520, 2160}};
+  const int iterations = 10;
+
+  std::vector<unsigned> threadCounts;
+  for (unsigned threads = 1; threads < SharedWorkerPool().Size(); threads *= 2) threadCounts.push_back(threads);
+  threadCounts.push_back(SharedWorkerPool().Size());
+
+  std::cout << "Pixel conversion kernel: " << ActiveSwizzleKernel().name << " | Pool threads: " << SharedWorkerPool().Size()
+            << " | Best of " << iterations << " runs\n\n";
+  std::cout << TextFormat("%-8s %-12s %8s %10s %10s %8s\n", "size", "resolution", "threads", "ms", "GB/s", "speedup");
+
+  for (const auto& size : sizes) {
+    std::vector<unsigned char> bgrx(static_cast<size_t>(size.width) * size.height * 4);
+    std::vector<unsigned char> rgba(bgrx.size());
+    for (size_t i = 0; i < bgrx.size(); i++) bgrx[i] = static_cast<unsigned char>(i * 31);
+
+    XImage img = {};
+    img.width = size.width;
+    img.height = size.height;
+    img.bytes_per_line = size.width * 4;
+    img.data = reinterpret_cast<char*>(bgrx.data());
+
+    double singleThreadMs = 0;
+    for (unsigned threads : threadCounts) {
+      double bestMs = 1e9;
+      for (int i = 0; i < iterations; i++) {
+        auto start = std::chrono::steady_clock::now();
+        ConvertBGRXToRGBAParallel(&img, rgba.data(), threads);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        bestMs = std::min(bestMs, elapsed.count());
+      }
+      if (threads == 1) singleThreadMs = bestMs;
+
+      // Bytes read + bytes written
+      double gigabytes = 2.0 * bgrx.size() / 1e9;
+      std::cout << TextFormat("%-8s %-12s %8u %10.2f %10.2f %7.2fx\n", size.name,
+                              TextFormat("%dx%d", size.width, size.height), threads, bestMs, gigabytes / (bestMs / 1000.0),
+                              singleThreadMs / bestMs);
+    }
+  }
+}
+
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ --check-swizzle: runs every BGRX → RGBA kernel the CPU supports against the scalar reference, byte for byte, on  │
+ * │ every length up to a few vector widths (so each tail path is hit), on misaligned buffers, and row by row through │
+ * │ padded source and destination strides; then the same for ConvertBGRXToRGBA with the active kernel. Bytes past    │
+ * │ each row are filled with a sentinel, so a kernel writing past its end fails too. Returns false on any mismatch.  │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+bool RunSwizzleCheck() {
+  const unsigned char SENTINEL = 0xA5;
+  std::vector<unsigned char> noise(1 << 16);
+  unsigned state = 12345;
+  for (unsigned char& byte : noise) {
+    state = state * 1103515245u + 12345u;
+    byte = static_cast<unsigned char>(state >> 16);
+  }
+
+  // Runs kernel over height rows of width pixels, with rows srcStride and dstStride bytes apart, from src + offset
+  auto convert = [&](SwizzleKernel kernel, int width, int height, size_t srcStride, size_t dstStride, size_t offset) {
+    std::vector<unsigned char> dst(dstStride * height + offset + 64, SENTINEL);
+    for (int row = 0; row < height; row++) {
+      kernel(noise.data() + offset + row * srcStride, dst.data() + offset + row * dstStride, width);
+    }
+    return dst;
+  };
+
+  const std::vector<SwizzleKernelInfo> kernels = AvailableSwizzleKernels();
+  bool ok = true;
+  int cases = 0;
+  for (const SwizzleKernelInfo& info : kernels) {
+    int failures = 0;
+    for (int width = 0; width <= 70; width++) {
+      for (size_t offset : {0, 1, 3, 4}) {
+        for (size_t padding : {0, 4, 12, 36}) {
+          const size_t srcStride = width * 4 + padding;
+          const size_t dstStride = width * 4 + (padding ? padding + 8 : 0);
+          const int height = 3;
+          cases++;
+          if (convert(info.kernel, width, height, srcStride, dstStride, offset) !=
+              convert(SwizzleBGRXToRGBAScalar, width, height, srcStride, dstStride, offset)) {
+            if (failures++ == 0) {
+              std::cerr << info.name << " differs from scalar: width " << width << ", offset " << offset
+                        << ", padding " << padding << std::endl;
+            }
+          }
+        }
+      }
+    }
+    std::cout << TextFormat("%-8s %s\n", info.name, failures == 0 ? "ok" : TextFormat("%d mismatches", failures));
+    ok = ok && failures == 0;
+  }
+
+  // The row walking in ConvertBGRXToRGBA, with tightly packed and padded rows on either side
+  int failures = 0;
+  for (int width : {1, 3, 7, 15, 17, 31, 33, 63, 65, 127, 1001}) {
+    for (int srcPadding : {0, 4, 28}) {
+      for (int dstPadding : {0, 4, 20}) {
+        const int height = 5;
+        XImage img = {};
+        img.width = width;
+        img.height = height;
+        img.bytes_per_line = width * 4 + srcPadding;
+        img.data = reinterpret_cast<char*>(noise.data());
+        const size_t dstStride = width * 4 + dstPadding;
+        std::vector<unsigned char> rgba(dstStride * height + 64, SENTINEL);
+        ConvertBGRXToRGBA(&img, rgba.data(), 0, height, dstPadding ? dstStride : 0);
+        cases++;
+        if (rgba != convert(SwizzleBGRXToRGBAScalar, width, height, img.bytes_per_line, dstStride, 0)) {
+          if (failures++ == 0) {
+            std::cerr << "ConvertBGRXToRGBA differs from scalar: width " << width << ", source padding " << srcPadding
+                      << ", destination padding " << dstPadding << std::endl;
+          }
+        }
+      }
+    }
+  }
+  std::cout << TextFormat("%-8s %s\n", "rows", failures == 0 ? "ok" : TextFormat("%d mismatches", failures));
+  std::cout << cases << " cases, active kernel: " << ActiveSwizzleKernel().name << std::endl;
+  return ok && failures == 0;
+}
+
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ --check-color-vision: builds each simulation LUT at the size the renderer uses and reports how far a trilinear   │
+ * │ lookup into it (what the GPU does) strays from the exact CPU reference, in 8-bit levels, and the same for the    │
+ * │ daltonization passes against Daltonize. Then checks Daltonize itself: it must leave grays alone (and everything  │
+ * │ for modes without a correction), and pull each dichromacy's confusion pair further apart as the viewer sees it.  │
+ * │ Returns false if one of those doesn't hold.                                                                      │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+bool RunColorVisionCheck() {
+  const int size = ColorVisionFilter::LUT_SIZE;
+  const int step = 3;  // every third level of each channel, ~600k colors per mode
+  std::cout << TextFormat("%-14s %10s %10s %10s %12s %12s\n", "mode", "build ms", "mean err", "max err",
+                          "dalton mean", "dalton max");
+
+  for (int mode = 1; mode < static_cast<int>(ColorVision::COUNT); mode++) {
+    ColorVision vision = static_cast<ColorVision>(mode);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<unsigned char> lut = BuildColorVisionLut(vision, size);
+    double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    LutError error = CompareColorVisionLut(vision, lut, size, step);
+    LutError daltonError = CompareDaltonization(vision, lut, size, step);
+    std::cout << TextFormat("%-14s %10.2f %10.3f %10d %12.3f %12d\n", ColorVisionName(vision), buildMs,
+                            error.meanError, error.maxError, daltonError.meanError, daltonError.maxError);
+  }
+
+  // Red/green for protans and deutans, blue/green for tritans: far apart, but close once simulated
+  static const unsigned char RED_GREEN[2][3] = {{200, 40, 40}, {40, 160, 40}};
+  static const unsigned char BLUE_GREEN[2][3] = {{40, 80, 200}, {40, 160, 120}};
+  auto distance = [](const unsigned char a[3], const unsigned char b[3]) {
+    return std::sqrt(std::pow(a[0] - b[0], 2.0) + std::pow(a[1] - b[1], 2.0) + std::pow(a[2] - b[2], 2.0));
+  };
+
+  bool ok = true;
+  for (int mode = 0; mode < static_cast<int>(ColorVision::COUNT); mode++) {
+    ColorVision vision = static_cast<ColorVision>(mode);
+    float shift[3][3];
+    const bool corrects = DaltonizeShift(vision, shift);
+    const bool dichromacy = vision == ColorVision::PROTANOPIA || vision == ColorVision::DEUTERANOPIA ||
+                            vision == ColorVision::TRITANOPIA;
+    if (corrects != dichromacy) {
+      std::cerr << "DaltonizeShift " << (corrects ? "corrects" : "doesn't correct") << " for "
+                << ColorVisionName(vision) << std::endl;
+      ok = false;
+    }
+
+    // Grays simulate to themselves, so there's no error to shift; without a correction no color changes at all
+    int moved = 0;
+    auto unchanged = [&](int r, int g, int b) {
+      const unsigned char color[3] = {static_cast<unsigned char>(r), static_cast<unsigned char>(g),
+                                      static_cast<unsigned char>(b)};
+      unsigned char out[3];
+      Daltonize(vision, color, out);
+      for (int channel = 0; channel < 3; channel++) moved = std::max(moved, std::abs(out[channel] - color[channel]));
+    };
+    for (int value = 0; value < 256; value++) unchanged(value, value, value);
+    for (int b = 0; b < 256 && !corrects; b += 15) {
+      for (int g = 0; g < 256; g += 15) {
+        for (int r = 0; r < 256; r += 15) unchanged(r, g, b);
+      }
+    }
+
+    const char* pair = "-";
+    if (corrects) {
+      const unsigned char(&colors)[2][3] = vision == ColorVision::TRITANOPIA ? BLUE_GREEN : RED_GREEN;
+      unsigned char seen[2][3];
+      unsigned char corrected[2][3];
+      unsigned char seenCorrected[2][3];
+      for (int i = 0; i < 2; i++) {
+        SimulateColorVision(vision, colors[i], seen[i]);
+        Daltonize(vision, colors[i], corrected[i]);
+        SimulateColorVision(vision, corrected[i], seenCorrected[i]);
+      }
+      const double before = distance(seen[0], seen[1]);
+      const double after = distance(seenCorrected[0], seenCorrected[1]);
+      pair = TextFormat("%.1f -> %.1f", before, after);
+      if (after <= before) {
+        std::cerr << "Daltonize doesn't separate the confusion pair for " << ColorVisionName(vision) << std::endl;
+        ok = false;
+      }
+    }
+    if (moved > 1) {
+      std::cerr << "Daltonize moves " << (corrects ? "a gray" : "a color") << " by " << moved << " levels for "
+                << ColorVisionName(vision) << std::endl;
+      ok = false;
+    }
+    std::cout << TextFormat("%-14s daltonize: %s moved by up to %d, confusion pair seen %s apart\n",
+                            ColorVisionName(vision), corrects ? "grays" : "colors", moved, pair);
+  }
+  return ok;
+}
+
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ --bench-glyphs: draws 50k glyphs of the debug font per frame, first with DrawTextEx and then with GlyphBatcher,  │
+ * │ and reports the average CPU time spent submitting them and the average whole-frame time for each.                │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+void RunGlyphBenchmark() {
+  const int glyphCount = 50000;
+  const int glyphsPerLine = 160;
+  const int warmupFrames = 30;
+  const int frames = 300;
+  const float fontSize = debugfont_base_size;
+
+  SetTraceLogLevel(LOG_WARNING);
+  InitWindow(1280, 720, "urblind glyph benchmark");
+  Font font = LoadDebugFont();
+  GlyphBatcher batcher;
+  batcher.Load(font);
+
+  // Lines of printable ASCII (no spaces, so every character is a glyph), stacked over the window again and again
+  std::vector<std::string> lines;
+  for (int glyph = 0; glyph < glyphCount; glyph += glyphsPerLine) {
+    std::string line;
+    for (int i = 0; i < std::min(glyphsPerLine, glyphCount - glyph); i++) {
+      line += static_cast<char>('!' + (glyph + i) % 94);
+    }
+    lines.push_back(line);
+  }
+  auto linePosition = [&](size_t line) { return Vector2{8.0f, 8.0f + (line % 38) * (fontSize + 2.0f)}; };
+
+  std::cout << "Drawing " << glyphCount << " glyphs per frame, averaged over " << frames << " frames\n\n";
+  std::cout << TextFormat("%-14s %12s %12s %14s\n", "renderer", "submit ms", "frame ms", "Mglyphs/s");
+
+  auto run = [&](const char* name, const std::function<void()>& drawGlyphs) {
+    double submitMs = 0;
+    double frameMs = 0;
+    for (int frame = 0; frame < warmupFrames + frames; frame++) {
+      auto frameStart = std::chrono::steady_clock::now();
+      BeginDrawing();
+      ClearBackground(BLACK);
+      auto submitStart = std::chrono::steady_clock::now();
+      drawGlyphs();
+      auto submitEnd = std::chrono::steady_clock::now();
+      EndDrawing();
+      auto frameEnd = std::chrono::steady_clock::now();
+      if (frame < warmupFrames) continue;
+      submitMs += std::chrono::duration<double, std::milli>(submitEnd - submitStart).count();
+      frameMs += std::chrono::duration<double, std::milli>(frameEnd - frameStart).count();
+    }
+    submitMs /= frames;
+    frameMs /= frames;
+    std::cout << TextFormat("%-14s %12.3f %12.3f %14.1f\n", name, submitMs, frameMs, glyphCount / (frameMs * 1000.0));
+  };
+
+  run("DrawTextEx", [&]() {
+    for (size_t i = 0; i < lines.size(); i++) DrawTextEx(font, lines[i].c_str(), linePosition(i), fontSize, 0, WHITE);
+  });
+  run("GlyphBatcher", [&]() {
+    for (size_t i = 0; i < lines.size(); i++) batcher.AddText(lines[i].c_str(), linePosition(i), fontSize, 0, WHITE);
+    batcher.Draw();
+  });
+
+  batcher.Unload();
+  UnloadFont(font);
+  CloseWindow();
+}
+
+// Options followed by a value, so the value (a size, a path) is never mistaken for a monitor index
+bool OptionTakesValue(const std::string& arg) {
+  static const char* const OPTIONS[] = {"--debug-anchor", "--capture-memory", "--max-texture-size", "--hotkey",
+                                        "--export-dir", "--frame-times-csv", "--profile-startup-trace"};
+  return std::any_of(std::begin(OPTIONS), std::end(OPTIONS), [&](const char* option) { return arg == option; });
+}
+
+bool IsMonitorIndex(const std::string& arg) {
+  return !arg.empty() && std::all_of(arg.begin(), arg.end(), ::isdigit);
+}
+
+// Monitor index from an argument IsMonitorIndex accepted, or the default (rightmost) monitor if it doesn't fit an int
+int ParseMonitorIndex(const std::string& arg) {
+  try {
+    return std::stoi(arg);
+  } catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << ". Falling back to the rightmost monitor.\n";
+    return ActivationListener::DEFAULT_MONITOR;
+  }
+}
+
+int main(int argc, char* argv[]) {
+  const auto launchTime = std::chrono::steady_clock::now();
+
+  // The rest of the desktop is captured on a background thread while GLFW talks to X on this one
+  XInitThreads();
+  Profiler().Reset(launchTime);
+  const int fontSize = debugfont_base_size;  // the debug font atlas is rasterized for exactly this size
+
+  int screenWidth = 640;
+  int screenHeight = 480;
+
+  float zoom = 1.0f;
+  float targetZoom = 1.0f;
+  const float minZoom = 0.1f;
+  const float maxZoom = 300.0f;
+  const float smoothingFactor = 7.5f;
+
+  bool dragging = false;
+  Vector2 pan = {0, 0};
+  Vector2 targetPan = {0, 0};
+
+  Vector2 mousePosition = {0, 0};
+  Vector2 previousMousePosition = {0, 0};
+  Vector2 mouseOnTexture = {0, 0};
+
+  float deltaTime = 0.0f;
+  int fps = 0.0f;
+
+  // Standalone modes that don't need a window
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--bench-glyphs") {
+      RunGlyphBenchmark();
+      return 0;
+    }
+
+    if (arg == "--bench-convert") {
+      RunConvertBenchmark();
+      return 0;
+    }
+
+    if (arg == "--check-swizzle") return RunSwizzleCheck() ? 0 : 1;
+
+    if (arg == "--check-color-vision") return RunColorVisionCheck() ? 0 : 1;
+    // Needs to be known before InitWindow, the first phase we time
+    if (arg == "--profile-startup" || arg == "--profile-startup-trace") Profiler().enabled = true;
+    if (arg == "--trigger") {
+      int monitorIndex = ActivationListener::DEFAULT_MONITOR;
+      for (int j = 1; j < argc; j++) {
+        std::string other = argv[j];
+        if (OptionTakesValue(other)) {
+          j++;
+          continue;
+        }
+        if (IsMonitorIndex(other)) monitorIndex = ParseMonitorIndex(other);
+      }
+      return ActivationListener::SendTrigger(monitorIndex) ? 0 : 1;
+    }
+  }
+
+  CaptureBackend captureBackend = CaptureBackend::NONE;
+  DesktopTexture desktop;
+  DesktopPixelCache pixelCache;
+  PixelGridOverlay pixelGrid;
+  IntegralImage integral;
+  ColorPicker colorPicker;
+  RegionSelection selection;
+  HistogramOverlay histogram;
+  ColorVisionFilter colorVision;
+  DaltonizePipeline daltonize;
+  PngExporter exporter;
+  FrameTimings frameTimings;
+  std::string frameTimesCsvPath;
+  BackgroundCapture backgroundCapture;
+  LiveCapture liveCapture;
+
+  SetConfigFlags(FLAG_WINDOW_HIDDEN);
+  Profiler().Begin("InitWindow");
+  InitWindow(screenWidth, screenHeight, "urblind");
+  Profiler().End();
+
+  DebugPanel debugPanel(12, 12, fontSize, 1.0f);
+  debugPanel.AddEntry("fps    ", [&]() { return TextFormat("%d", fps); });
+  debugPanel.AddEntry("frame  ", [&]() {
+    const FrameTimings::Stats& stats = frameTimings.TotalStats();
+    return TextFormat("p50 %.1f p95 %.1f p99 %.1f max %.1f ms", stats.p50, stats.p95, stats.p99, stats.max);
+  });
+  debugPanel.SetFooter(fontSize * 3, [&](Rectangle area) { DrawFrameTimeGraph(frameTimings, area); });
+  debugPanel.AddEntry("mouse  ", [&]() { return TextFormat("%05.0f, %05.0f", mousePosition.x, mousePosition.y); });
+  debugPanel.AddEntry("texure ", [&]() { return TextFormat("%05.0f, %05.0f", mouseOnTexture.x, mouseOnTexture.y); });
+  debugPanel.AddEntry("pan    ", [&]() { return TextFormat("%05.0f, %05.0f", pan.x, pan.y); });
+  debugPanel.AddEntry("zoom   ", [&]() { return TextFormat("%.2f", zoom); });
+  debugPanel.AddEntry("capture", [&]() { return CaptureBackendName(captureBackend); });
+  debugPanel.AddEntry("upload ", [&]() { return desktop.uploadPath; });
+  debugPanel.AddEntry("cpu mem", [&]() {
+    return TextFormat("%s, %.1f MB", CaptureMemoryName(desktop.memoryPolicy), desktop.RetainedBytes() / 1048576.0);
+  });
+  debugPanel.AddEntry("live   ", [&]() {
+    if (!liveCapture.Active()) return "off";
+    return TextFormat("%d rects, %.1f Kpx", liveCapture.updatedRects, liveCapture.updatedPixels / 1000.0);
+  });
+  debugPanel.AddEntry("age    ", [&]() {
+    if (!liveCapture.Active()) return "-";
+    return TextFormat("%.1f ms, %u dropped", liveCapture.frameAgeMs, liveCapture.droppedFrames.load());
+  });
+  debugPanel.AddEntry("pixels ", [&]() {
+    if (!pixelCache.Held()) return "-";
+    return TextFormat("%.1f s old%s", pixelCache.Age(), liveCapture.Active() ? ", paused (live)" : "");
+  });
+  debugPanel.AddEntry("color  ", [&]() { return colorPicker.Describe(); });
+  debugPanel.AddEntry("region ", [&]() { return selection.DescribeArea(); });
+  debugPanel.AddEntry("  red  ", [&]() { return selection.DescribeChannel(0); });
+  debugPanel.AddEntry("  green", [&]() { return selection.DescribeChannel(1); });
+  debugPanel.AddEntry("  blue ", [&]() { return selection.DescribeChannel(2); });
+  debugPanel.AddEntry("hist   ", [&]() { return histogram.Describe(); });
+  debugPanel.AddEntry("vision ", [&]() { return ColorVisionName(colorVision.mode); });
+  debugPanel.AddEntry("dalton ", [&]() { return daltonize.Describe(colorVision); });
+  debugPanel.AddEntry("export ", [&]() { return exporter.Describe(); });
+  debugPanel.AddEntry("grid   ", [&]() {
+    if (!pixelGrid.enabled) return "off";
+    return pixelGrid.labelCount > 0 ? TextFormat("%d labels", pixelGrid.labelCount) : "on";
+  });
+  debugPanel.AddEntry("stream ", [&]() {
+    int remaining = backgroundCapture.Remaining();
+    return remaining > 0 ? TextFormat("%d regions pending", remaining) : "complete";
+  });
+
+  MonitorState monitorState;
+
+  int selectedMonitor = -1;
+
+  bool debugMode = false;
+  bool cpuSwizzle = false;
+  bool daemonMode = false;
+  bool liveMode = false;
+  std::string hotkey;
+  std::string profileTracePath;
+  std::optional<DebugAnchor> debugAnchor;
+
+  // First pass: Parse all flags and options, remembering which arguments were option values
+  std::vector<bool> optionValues(argc, false);
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (OptionTakesValue(arg) && i + 1 < argc) optionValues[i + 1] = true;
 
     if (arg == "--debug") {
       debugMode = true;
       continue;
     }
 
+    if (arg == "--cpu-swizzle") {
+      cpuSwizzle = true;
+      continue;
+    }
+
+    if (arg == "--daemon") {
+      daemonMode = true;
+      continue;
+    }
+
+    if (arg == "--live") {
+      liveMode = true;
+      continue;
+    }
+
+    if (arg == "--hotkey" && i + 1 < argc) {
+      hotkey = argv[++i];
+      continue;
+    }
+
+    if (arg == "--capture-memory" && i + 1 < argc) {
+      std::string policyArg = argv[++i];
+      if (auto policy = ParseCaptureMemory(policyArg)) {
+        desktop.memoryPolicy = *policy;
+      } else {
+        std::cerr << "Warning: Invalid --capture-memory value. Defaulting to 'drop'.\n";
+      }
+      continue;
+    }
+
+    if (arg == "--max-texture-size" && i + 1 < argc) {
+      desktop.maxTextureSize = std::atoi(argv[++i]);
+      continue;
+    }
+
+    if (arg == "--export-dir" && i + 1 < argc) {
+      exporter.directory = argv[++i];
+      continue;
+    }
+
+    if (arg == "--frame-times-csv" && i + 1 < argc) {
+      frameTimesCsvPath = argv[++i];
+      frameTimings.keepAll = true;
+      continue;
+    }
+
+    if (arg == "--profile-startup") continue;  // handled before InitWindow
+
+    if (arg == "--profile-startup-trace" && i + 1 < argc) {
+      profileTracePath = argv[++i];
+      continue;
+    }
+
     if (arg == "--debug-anchor" && i + 1 < argc) {
       std::string anchorArg = argv[++i];  // Move to the next argument
       if (anchorArg == "tl")
@@ -468,12 +3755,40 @@ int main(int argc, char* argv[]) {
                   << monitorState.positions[i].y << ")\n";
       }
       std::cout << std::endl;
-      std::cout << "Usage: " << argv[0] << " [monitor_index] [--debug] [--debug-anchor {tl|tr|bl|br}]" << std::endl;
+      std::cout << "Usage: " << argv[0] << " [monitor_index] [--debug] [--debug-anchor {tl|tr|bl|br}] [--cpu-swizzle]"
+                << " [--capture-memory {drop|compressed|full}] [--max-texture-size <px>] [--live]"
+                << " [--daemon [--hotkey <keys>]] [--trigger] [--export-dir <dir>] [--frame-times-csv <file>]"
+                << " [--profile-startup] [--profile-startup-trace <file>] [--bench-convert]"
+                << " [--bench-glyphs] [--check-swizzle] [--check-color-vision]" << std::endl;
       std::cout << std::endl;
       std::cout << "Options:\n"
                 << "  --help                        Show this help message and exit." << std::endl
                 << "  --debug                       Enable debug panel." << std::endl
-                << "  --debug-anchor {tl|tr|bl|br}  Set debug panel anchor position." << std::endl;
+                << "  --debug-anchor {tl|tr|bl|br}  Set debug panel anchor position." << std::endl
+                << "  --cpu-swizzle                 Convert pixels on the CPU instead of swizzling on the GPU." << std::endl
+                << "  --capture-memory {drop|compressed|full}  Keep a CPU copy of the capture (default: drop)."
+                << std::endl
+                << "  --max-texture-size <px>       Split the desktop into tiles above this size (default: GL limit)."
+                << std::endl
+                << "  --live                        Keep updating the parts of the screen that change." << std::endl
+                << "  --daemon                      Stay resident and hidden; show up when triggered, hide on Escape."
+                << std::endl
+                << "  --hotkey <keys>               Daemon hotkey grabbed from X, e.g. Mod4+z or ctrl+alt+Print." << std::endl
+                << "  --trigger                     Tell a running daemon to show up (on [monitor_index] if given)."
+                << std::endl
+                << "  --export-dir <dir>            Where S and Shift+S save PNG exports (default: current directory)."
+                << std::endl
+                << "  --frame-times-csv <file>      Write every frame's phase timings to a CSV file on exit."
+                << std::endl
+                << "  --profile-startup             Print how long each startup phase took up to the first frame."
+                << std::endl
+                << "  --profile-startup-trace <file>  Also write the startup phases as Chrome trace JSON." << std::endl
+                << "  --bench-convert               Benchmark the screenshot pixel conversion and exit." << std::endl
+                << "  --bench-glyphs                Benchmark drawing 50k glyphs per frame and exit." << std::endl
+                << "  --check-swizzle               Check each pixel conversion kernel against the scalar one and exit."
+                << std::endl
+                << "  --check-color-vision          Compare the color vision LUTs and passes with the reference and exit."
+                << std::endl;
       std::cout << std::endl;
       std::cout << "If no monitor index is provided, the rightmost monitor is used by default.\n" << std::endl;
       DrawMonitorLayout(monitorState);
@@ -485,131 +3800,332 @@ int main(int argc, char* argv[]) {
   for (int i = 1; i < argc; i++) {
     std::string arg = argv[i];
 
-    // If argument is numeric, treat it as a monitor index
-    if (!arg.empty() && std::all_of(arg.begin(), arg.end(), ::isdigit)) {
-      try {
-        selectedMonitor = std::stoi(arg);
+    // If argument is numeric (and not the value of an option), treat it as a monitor index
+    if (!optionValues[i] && IsMonitorIndex(arg)) {
+      selectedMonitor = ParseMonitorIndex(arg);
+      if (selectedMonitor != ActivationListener::DEFAULT_MONITOR) {
         std::cout << "Monitor selected by command arguments: " << selectedMonitor << std::endl;
-      } catch (const std::exception& e) {
-        std::cerr << "Error: " << e.what() << ". Falling back to the rightmost monitor.\n";
-        selectedMonitor = -1;
       }
     }
   }
 
   // Apply parsed arguments
+  bool reportedStartup = false;
   if (debugMode) debugPanel.SetVisible(true);
   if (debugAnchor) debugPanel.SetAnchor(*debugAnchor);
 
-  // Default to the rightmost monitor if no valid selection is made
-  if (selectedMonitor != -1) {
-    selectedMonitor = monitorState.getRealMonitorIndex(selectedMonitor);
-    if (selectedMonitor == -1) {
-      std::cerr << "Invalid monitor index! Falling back to the rightmost monitor.\n";
-      selectedMonitor = monitorState.spatialMonitorIndexes.back();
-    }
-  }
-  std::cout << "Using monitor " << selectedMonitor << "\n";
-  screenWidth = GetMonitorWidth(selectedMonitor);
-  screenHeight = GetMonitorHeight(selectedMonitor);
+  ActivationListener activation;
+  if (daemonMode && !activation.Start(hotkey)) return -1;
 
-  SetWindowSize(screenWidth, screenHeight);
+  while (true) {
+    int sessionMonitor = selectedMonitor;
+    if (daemonMode) {
+      std::cout << "Waiting for activation..." << std::endl;
+      int requestedMonitor = activation.Wait();
+      if (requestedMonitor != ActivationListener::DEFAULT_MONITOR) sessionMonitor = requestedMonitor;
+    }
+    auto activationStart = std::chrono::steady_clock::now();
+    if (daemonMode) Profiler().Reset(activationStart);  // profile each activation on its own
 
-  pan.x = GetMonitorPosition(selectedMonitor).x;
-  pan.y = GetMonitorPosition(selectedMonitor).y;
-  targetPan.x = pan.x;
-  targetPan.y = pan.y;
-  Rectangle source = {pan.x, pan.y, screenWidth / zoom, screenHeight / zoom};
-  Rectangle dest = {0, 0, static_cast<float>(screenWidth), static_cast<float>(screenHeight)};
+    // Default to the rightmost monitor if no valid selection is made
+    int realMonitor = monitorState.spatialMonitorIndexes.back();
+    if (sessionMonitor != -1) {
+      realMonitor = monitorState.getRealMonitorIndex(sessionMonitor);
+      if (realMonitor == -1) {
+        std::cerr << "Invalid monitor index! Falling back to the rightmost monitor.\n";
+        realMonitor = monitorState.spatialMonitorIndexes.back();
+      }
+    }
+    std::cout << "Using monitor " << realMonitor << "\n";
+    screenWidth = GetMonitorWidth(realMonitor);
+    screenHeight = GetMonitorHeight(realMonitor);
 
-  Image screenshot = CaptureScreenX11(0, 0, monitorState.totalWidth, monitorState.totalHeight);
-  ClearWindowState(FLAG_WINDOW_HIDDEN);
-  SetConfigFlags(FLAG_WINDOW_UNDECORATED);
-  SetWindowPosition(static_cast<int>(GetMonitorPosition(selectedMonitor).x),
-                    static_cast<int>(GetMonitorPosition(selectedMonitor).y));
+    SetWindowSize(screenWidth, screenHeight);
 
-  if (screenshot.data == nullptr) {
-    std::cerr << "Failed to capture screen!" << std::endl;
-    return -1;
-  }
+    zoom = 1.0f;
+    targetZoom = 1.0f;
+    dragging = false;
+    pan.x = GetMonitorPosition(realMonitor).x;
+    pan.y = GetMonitorPosition(realMonitor).y;
+    targetPan.x = pan.x;
+    targetPan.y = pan.y;
 
-  Texture2D texture = LoadTextureFromImage(screenshot);
-  SetTextureWrap(texture, TEXTURE_WRAP_MIRROR_REPEAT);
-  SetTextureFilter(texture, TEXTURE_FILTER_POINT);
+    // Only the monitor we're about to cover is captured up front; the rest of the desktop is streamed in afterwards
+    Vector2 monitorPosition = GetMonitorPosition(realMonitor);
+    Rectangle monitorRect = {monitorPosition.x, monitorPosition.y,
+                             std::min<float>(screenWidth, monitorState.totalWidth - monitorPosition.x),
+                             std::min<float>(screenHeight, monitorState.totalHeight - monitorPosition.y)};
+    bool allocated = desktop.Allocate(monitorState.totalWidth, monitorState.totalHeight, !cpuSwizzle);
 
-  bool shouldClose = false;
+    // Subscribe to damage before capturing anything, so no change between the capture and the first update is lost
+    if (liveMode && allocated) {
+      liveCapture.Start(monitorState.totalWidth, monitorState.totalHeight, monitorRect, !desktop.gpuSwizzle);
+    }
 
-  /**
-   * ┌────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
-   * │ Main loop                                                                                                      │
-   * └────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
-   */
-  while (!shouldClose) {
-    deltaTime = GetFrameTime();
-    fps = GetFPS();
+    ScreenCapture capture;
+    bool captured =
+        allocated && CaptureScreenX11(monitorRect.x, monitorRect.y, monitorRect.width, monitorRect.height, capture);
+    ClearWindowState(FLAG_WINDOW_HIDDEN);
+    SetConfigFlags(FLAG_WINDOW_UNDECORATED);
+    SetWindowPosition(static_cast<int>(GetMonitorPosition(realMonitor).x),
+                      static_cast<int>(GetMonitorPosition(realMonitor).y));
+    if (daemonMode) SetWindowFocused();
 
-    if (IsKeyPressed(KEY_ESCAPE)) shouldClose = true;
-    if (IsKeyPressed(KEY_F11)) ToggleFullscreen();
-    if (IsKeyPressed(KEY_TAB)) debugPanel.visible = !debugPanel.visible;
+    bool uploaded = captured && desktop.UploadCapture(capture.image, monitorRect.x, monitorRect.y);
+    captureBackend = capture.backend;
+    ReleaseScreenCapture(capture);
+    if (!uploaded) {
+      std::cerr << (!allocated  ? "Failed to allocate the screenshot texture!"
+                    : captured ? "Failed to upload the screenshot texture!"
+                               : "Failed to capture screen!")
+                << std::endl;
+      if (!daemonMode) return -1;
 
-    if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-      dragging = true;
-      previousMousePosition = GetMousePosition();
+      // A resident daemon shouldn't die because one activation went wrong
+      liveCapture.Stop();
+      SetWindowState(FLAG_WINDOW_HIDDEN);
+      continue;
     }
+    backgroundCapture.Start(DesktopRegionsAround(monitorRect, monitorState.totalWidth, monitorState.totalHeight),
+                            !desktop.gpuSwizzle);
 
-    if (IsMouseButtonReleased(MOUSE_LEFT_BUTTON)) dragging = false;
+    bool shouldClose = false;
+    bool firstFrame = true;
+    bool eventWaiting = false;
 
-    mousePosition = GetMousePosition();
-    if (dragging) {
-      targetPan.x -= (mousePosition.x - previousMousePosition.x) / zoom;
-      targetPan.y -= (mousePosition.y - previousMousePosition.y) / zoom;
-      previousMousePosition = mousePosition;
-    }
+    /**
+     * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+     * │ Main loop                                                                                                    │
+     * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+     */
+    while (!shouldClose) {
+      frameTimings.BeginFrame();
+      deltaTime = GetFrameTime();
+      // After sleeping in the event wait, the frame time is however long we slept; animate from the next input as if
+      // we had been rendering all along instead of jumping straight to the target
+      if (eventWaiting) deltaTime = std::min(deltaTime, 1.0f / 60.0f);
+      fps = GetFPS();
+
+      if (IsKeyPressed(KEY_ESCAPE)) shouldClose = true;
+      if (IsKeyPressed(KEY_F11)) ToggleFullscreen();
+      if (IsKeyPressed(KEY_TAB)) debugPanel.SetVisible(!debugPanel.visible);
+      if (IsKeyPressed(KEY_G)) pixelGrid.Toggle();
+      if (IsKeyPressed(KEY_P)) colorPicker.Toggle();
+      if (IsKeyPressed(KEY_H)) histogram.Toggle();
+      if (IsKeyPressed(KEY_RIGHT_BRACKET)) colorPicker.GrowKernel();
+      if (IsKeyPressed(KEY_LEFT_BRACKET)) colorPicker.ShrinkKernel();
+      const bool controlDown = IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL);
+      if (controlDown && IsKeyPressed(KEY_C)) colorPicker.CopyToClipboard();
+      if (!controlDown && IsKeyPressed(KEY_C)) colorVision.Cycle();
+      if (IsKeyPressed(KEY_D)) daltonize.Cycle();
+
+      // Left drag pans, Shift + left drag selects a region instead
+      const bool shiftDown = IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT);
+      if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
+        if (shiftDown) {
+          selection.Begin(GetMousePositionOnTexture(GetMousePosition(), pan, zoom));
+        } else {
+          dragging = true;
+          previousMousePosition = GetMousePosition();
+        }
+      }
+
+      if (IsMouseButtonReleased(MOUSE_LEFT_BUTTON)) {
+        dragging = false;
+        selection.End();
+      }
+
+      mousePosition = GetMousePosition();
+      selection.Drag(GetMousePositionOnTexture(mousePosition, pan, zoom));
+      if (dragging) {
+        targetPan.x -= (mousePosition.x - previousMousePosition.x) / zoom;
+        targetPan.y -= (mousePosition.y - previousMousePosition.y) / zoom;
+        previousMousePosition = mousePosition;
+      }
+
+      float wheel = GetMouseWheelMove();
+      float previousZoom = zoom;
+      mouseOnTexture = GetMousePositionOnTexture(mousePosition, pan, zoom);
+      if (wheel != 0) {
+        float zoomFactor = 1.05f;
+        if (wheel > 0) {
+          targetZoom *= zoomFactor;
+        } else {
+          targetZoom /= zoomFactor;
+        }
+
+        targetZoom = std::max(minZoom, std::min(targetZoom, maxZoom));
+        targetPan = ComputeTargetPan(mouseOnTexture, previousZoom, targetZoom, pan);
+      }
+
+      frameTimings.Mark(FrameTimings::INPUT);
+
+      const float smoothing = 1.0f - exp(-smoothingFactor * deltaTime);
+      const float previousFrameZoom = zoom;
+      const Vector2 previousFramePan = pan;
+      zoom += (targetZoom - zoom) * smoothing;
+      pan.x += (targetPan.x - pan.x) * smoothing;
+      pan.y += (targetPan.y - pan.y) * smoothing;
 
-    float wheel = GetMouseWheelMove();
-    float previousZoom = zoom;
-    mouseOnTexture = GetMousePositionOnTexture(mousePosition, pan, zoom);
-    if (wheel != 0) {
-      float zoomFactor = 1.05f;
-      if (wheel > 0) {
-        targetZoom *= zoomFactor;
+      ClampPan(pan, zoom, {static_cast<float>(desktop.width), static_cast<float>(desktop.height)},
+               {static_cast<float>(screenWidth), static_cast<float>(screenHeight)});
+
+      // Settled once a frame moves the view by less than a twentieth of a screen pixel (pan is compared after
+      // clamping, since a target past the desktop edge is never reached)
+      const bool settled = std::fabs(zoom - previousFrameZoom) < zoom * 1e-4f &&
+                           std::fabs(pan.x - previousFramePan.x) * zoom < 0.05f &&
+                           std::fabs(pan.y - previousFramePan.y) * zoom < 0.05f;
+
+      Rectangle source = {pan.x, pan.y, screenWidth / zoom, screenHeight / zoom};
+      Rectangle dest = {0, 0, static_cast<float>(screenWidth), static_cast<float>(screenHeight)};
+
+      // TODO: MAYBE adjust the dest rectangle to clamp the texture when it is zoomed out and smaller than the viewport?
+      // I kinda like the mirrored repeat texture wrapping though. It feels unpolished but it looks cool.
+
+      frameTimings.Mark(FrameTimings::CAMERA);
+
+      if (IsKeyPressed(KEY_S)) {
+        if (backgroundCapture.Remaining() > 0) {
+          std::cerr << "The desktop is still being captured, try the export again in a moment" << std::endl;
+        } else if (shiftDown) {
+          Rectangle everything = {0, 0, static_cast<float>(desktop.width), static_cast<float>(desktop.height)};
+          exporter.Start(desktop.Pixels(), everything, "desktop");
+        } else {
+          Rectangle view = ClipToPixels(source, desktop.width, desktop.height);
+          exporter.Start(desktop.PixelsIn(view), {0, 0, view.width, view.height}, "view");
+        }
+      }
+
+      // Merge whatever the background capture has finished since the last frame
+      CapturePatch patch;
+      while (backgroundCapture.TakePatch(patch)) desktop.UploadPixels(patch.rec, patch.pixels.data());
+
+      // Live updates only start once the streamed regions are in, or a stale region could land on top of a fresh one
+      if (liveCapture.Active() && backgroundCapture.Remaining() == 0) {
+        const unsigned before = desktop.Generation();
+        liveCapture.Update(desktop);
+        pixelCache.SkipChanges(before, desktop.Generation());
+      }
+      frameTimings.Mark(FrameTimings::UPLOAD);
+
+      if (firstFrame) Profiler().Begin("First frame");
+
+      BeginDrawing();
+      ClearBackground(BLACK);
+      // The desktop is seen through the color vision simulation, or through the daltonization passes on top of it
+      const bool daltonizing = daltonize.Active(colorVision);
+      if (daltonizing) {
+        daltonize.BeginScene(screenWidth, screenHeight);
       } else {
-        targetZoom /= zoomFactor;
+        colorVision.Begin();
+      }
+      desktop.Draw(source, dest, WHITE);
+      if (daltonizing) {
+        daltonize.EndScene(colorVision);
+      } else {
+        colorVision.End();
       }
 
-      targetZoom = std::max(minZoom, std::min(targetZoom, maxZoom));
-      targetPan = ComputeTargetPan(mouseOnTexture, previousZoom, targetZoom, pan);
-    }
+      // Overlays that read pixel values share one CPU snapshot, which is let go as soon as none of them is on
+      const bool wantsIntegral = colorPicker.enabled || selection.Active();
+      const bool wantsPixels = pixelGrid.WantsLabels(zoom) || wantsIntegral || histogram.enabled;
+      if (!pixelGrid.enabled && !wantsIntegral && !histogram.enabled) pixelCache.Release();
+      if (!wantsIntegral) integral.Release();
+      const DesktopPixels* pixels = wantsPixels ? pixelCache.Get(desktop) : nullptr;
+      pixelGrid.Draw(pan, zoom, screenWidth, screenHeight, pixels);
+      if (wantsIntegral) integral.Update(pixels, pixelCache.Version(), selection.Active());
+
+      Vector2 hovered = GetMousePositionOnTexture(mousePosition, pan, zoom);
+      const int hoveredX = static_cast<int>(std::floor(hovered.x));
+      const int hoveredY = static_cast<int>(std::floor(hovered.y));
+      colorPicker.Update(integral, hoveredX, hoveredY);
+      colorPicker.DrawKernelOutline(pan, zoom, hoveredX, hoveredY);
+      selection.Update(integral, pixelCache.Version());
+      selection.Draw(pan, zoom);
+      histogram.Update(pixels, pixelCache.Version(), selection.Active() ? selection.Area() : source);
 
-    const float smoothing = 1.0f - exp(-smoothingFactor * deltaTime);
-    zoom += (targetZoom - zoom) * smoothing;
-    pan.x += (targetPan.x - pan.x) * smoothing;
-    pan.y += (targetPan.y - pan.y) * smoothing;
+      debugPanel.Draw();
+      histogram.Draw(debugPanel.visible ? debugPanel.bounds : Rectangle{0, 8, 0, 0});
 
-    ClampPan(pan, zoom, {static_cast<float>(texture.width), static_cast<float>(texture.height)},
-             {static_cast<float>(screenWidth), static_cast<float>(screenHeight)});
+      // Nothing moving, nobody dragging and nothing left to stream in: let EndDrawing block until the next input
+      // event (or a capture thread's wake-up) instead of redrawing the very same frame at the monitor refresh rate
+      const bool idle = settled && !dragging && !selection.selecting && !exporter.Busy() &&
+                        backgroundCapture.Remaining() == 0 && !(wantsPixels && pixelCache.Pending(desktop));
+      if (idle != eventWaiting) {
+        if (idle) {
+          EnableEventWaiting();
+        } else {
+          DisableEventWaiting();
+        }
+        eventWaiting = idle;
+      }
 
-    Rectangle source = {pan.x, pan.y, screenWidth / zoom, screenHeight / zoom};
-    Rectangle dest = {0, 0, static_cast<float>(screenWidth), static_cast<float>(screenHeight)};
+      frameTimings.Mark(FrameTimings::DRAW);
+      if (firstFrame) Profiler().Begin("EndDrawing");
+      EndDrawing();
+      frameTimings.Mark(FrameTimings::PRESENT);
+      frameTimings.EndFrame(!eventWaiting);  // an EndDrawing that waited for input measured idle time, not work
+      if (firstFrame) {
+        Profiler().End();  // EndDrawing
+        Profiler().End();  // First frame
+      }
 
-    // TODO: MAYBE adjust the dest rectangle to clamp the texture when it is zoomed out and smaller than the viewport?
-    // I kinda like the mirrored repeat texture wrapping though. It feels unpolished but it looks cool.
+      if (firstFrame) {
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - activationStart;
+        std::cout << "Activation to first frame: " << TextFormat("%.1f", elapsed.count()) << " ms" << std::endl;
+        if (!reportedStartup) {
+          std::chrono::duration<double, std::milli> sinceLaunch = std::chrono::steady_clock::now() - launchTime;
+          std::cout << "Startup report: " << TextFormat("%.1f", sinceLaunch.count()) << " ms from launch to first frame"
+                    << " | debug font: "
+                    << (debugPanel.fontLoaded ? TextFormat("loaded in %.2f ms", debugPanel.fontLoadMs)
+                                              : "deferred until the panel is shown")
+                    << std::endl;
+          reportedStartup = true;
+        }
 
-    BeginDrawing();
-    ClearBackground(BLACK);
-    DrawTexturePro(texture, source, dest, {0, 0}, 0, WHITE);
+        Profiler().PrintTable(std::cout);
+        if (!profileTracePath.empty()) {
+          if (Profiler().WriteChromeTrace(profileTracePath)) {
+            std::cout << "Startup trace written to " << profileTracePath << std::endl;
+          } else {
+            std::cerr << "Failed to write the startup trace to " << profileTracePath << std::endl;
+          }
+        }
+        Profiler().Finish();
+        firstFrame = false;
+      }
+    }
+    /**
+     * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+     * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+     */
 
-    debugPanel.Draw();
+    if (eventWaiting) DisableEventWaiting();
+    backgroundCapture.Stop();
+    liveCapture.Stop();
+    if (!daemonMode) break;
 
-    EndDrawing();
+    // Escape only sends the daemon back into hiding; the window, GL context, font and texture all stay alive
+    SetWindowState(FLAG_WINDOW_HIDDEN);
+    activation.Drain();
+  }
+
+  if (!frameTimesCsvPath.empty()) {
+    if (frameTimings.WriteCsv(frameTimesCsvPath)) {
+      std::cout << "Frame timings written to " << frameTimesCsvPath << std::endl;
+    } else {
+      std::cerr << "Failed to write the frame timings to " << frameTimesCsvPath << std::endl;
+    }
   }
-  /**
-   * ┌────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
-   * └────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
-   */
 
-  UnloadTexture(texture);
-  UnloadImage(screenshot);
+  if (exporter.Busy()) std::cout << "Waiting for the PNG export to finish..." << std::endl;
+  exporter.Wait();
+  pixelCache.Release();
+  pixelGrid.Unload();
+  daltonize.Unload();
+  colorVision.Unload();
+  desktop.Unload();
+  debugPanel.Dispose();
   CloseWindow();
   return 0;
 }
@@ -0,0 +1,93 @@
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "../include/monospacedfont.hpp"
+#include "raylib.h"
+
+/**
+ * ┌──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┐
+ * │ Build-time helper that rasterizes the embedded debug panel font into a glyph atlas and writes it out as a C++    │
+ * │ header (one alpha byte per texel + a glyph metrics table). It goes through the very same raylib calls that       │
+ * │ LoadFontFromMemory uses (LoadFontData + GenImageFontAtlas), so the result is identical to what urblind used to   │
+ * │ rasterize at every launch, but the app no longer has to embed the 2.4 MB TTF nor parse it at runtime.           │
+ * │                                                                                                                  │
+ * │ Usage: bakefont <output_header> <font_size>                                                                      │
+ * └──────────────────────────────────────────────────────────────────────────────────────────────────────────────────┘
+ */
+
+// Same values LoadFontFromMemory uses: printable ASCII (32..126) and 4 pixels of padding around each glyph
+const int glyphCount = FONT_TTF_DEFAULT_NUMCHARS;
+const int glyphPadding = 4;
+
+int main(int argc, char* argv[]) {
+  if (argc != 3) {
+    std::cerr << "Usage: " << argv[0] << " <output_header> <font_size>" << std::endl;
+    return 1;
+  }
+  const std::string outputPath = argv[1];
+  const int fontSize = std::atoi(argv[2]);
+
+  SetTraceLogLevel(LOG_WARNING);
+
+  GlyphInfo* glyphs = LoadFontData(monofont_ttf, monofont_ttf_len, fontSize, nullptr, glyphCount, FONT_DEFAULT);
+  if (!glyphs) {
+    std::cerr << "Failed to rasterize the embedded font!" << std::endl;
+    return 1;
+  }
+
+  Rectangle* recs = nullptr;
+  Image atlas = GenImageFontAtlas(glyphs, &recs, glyphCount, fontSize, glyphPadding, 0);
+  if (!atlas.data || (atlas.format != PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA &&
+                      atlas.format != PIXELFORMAT_UNCOMPRESSED_GRAYSCALE)) {
+    std::cerr << "Failed to generate the font atlas!" << std::endl;
+    return 1;
+  }
+
+  std::ofstream out(outputPath);
+  if (!out) {
+    std::cerr << "Cannot write " << outputPath << std::endl;
+    return 1;
+  }
+
+  out << "// Generated by tools/bakefont.cpp from include/monospacedfont.hpp at build time. Do not edit.\n"
+      << "#pragma once\n\n"
+      << "const int debugfont_base_size = " << fontSize << ";\n"
+      << "const int debugfont_glyph_padding = " << glyphPadding << ";\n"
+      << "const int debugfont_glyph_count = " << glyphCount << ";\n"
+      << "const int debugfont_atlas_width = " << atlas.width << ";\n"
+      << "const int debugfont_atlas_height = " << atlas.height << ";\n\n";
+
+  // The atlas is white everywhere, only the alpha channel carries the glyphs, so that's all we keep
+  const unsigned char* texels = static_cast<const unsigned char*>(atlas.data);
+  const int bytesPerTexel = atlas.format == PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA ? 2 : 1;
+  const int texelCount = atlas.width * atlas.height;
+  out << "const unsigned char debugfont_atlas_alpha[] = {";
+  for (int i = 0; i < texelCount; i++) {
+    if (i % 24 == 0) out << "\n  ";
+    out << static_cast<int>(texels[i * bytesPerTexel + bytesPerTexel - 1]) << (i + 1 < texelCount ? "," : "");
+  }
+  out << "\n};\n\n";
+
+  out << "struct DebugFontGlyph {\n"
+      << "  int codepoint, offsetX, offsetY, advanceX;\n"
+      << "  float x, y, width, height;\n"
+      << "};\n\n"
+      << "const DebugFontGlyph debugfont_glyphs[] = {\n";
+  for (int i = 0; i < glyphCount; i++) {
+    out << "  {" << glyphs[i].value << ", " << glyphs[i].offsetX << ", " << glyphs[i].offsetY << ", "
+        << glyphs[i].advanceX << ", " << recs[i].x << ", " << recs[i].y << ", " << recs[i].width << ", "
+        << recs[i].height << "},\n";
+  }
+  out << "};\n";
+
+  UnloadImage(atlas);
+  UnloadFontData(glyphs, glyphCount);
+  MemFree(recs);
+
+  std::cout << "Baked " << glyphCount << " glyphs at " << fontSize << "px into a " << atlas.width << "x"
+            << atlas.height << " atlas: " << outputPath << std::endl;
+  return out.good() ? 0 : 1;
+}